@@ -33,9 +33,14 @@ namespace app_config {
     const std::string DEFAULT_RTMP_URL = "rtmp://anhoidong.datacenter.cvedix.com:1935/live/camera_traffic_usa_ai";
 
     // Application Settings
-    constexpr bool ENABLE_ANALYSIS_BOARD = true;
+    // Analysis board and metrics endpoint both use the node meta hookers, only one of them can be enabled
+    constexpr bool ENABLE_ANALYSIS_BOARD = false;
     constexpr int ANALYSIS_BOARD_DISPLAY_INTERVAL = 1;
 
+    // Prometheus metrics endpoint (http://METRICS_ADDRESS:METRICS_PORT/metrics), 0 disables it
+    constexpr int METRICS_PORT = 9464;
+    const std::string METRICS_ADDRESS = "127.0.0.1";
+
 } // namespace app_config
 
 #endif // CONFIG_H
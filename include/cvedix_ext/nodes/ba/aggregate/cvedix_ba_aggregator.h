@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace cvedix_nodes {
+    struct cvedix_ba_aggregator_config {
+        double bucket_seconds = 1;      // resolution of sliding window
+        int window_buckets = 60;        // window length = bucket_seconds * window_buckets
+    };
+
+    // kinds of zone results counted apart
+    enum class cvedix_ba_zone_event {
+        JAM,
+        STOP,
+        OTHER                           // any other region based result
+    };
+
+    struct cvedix_ba_line_summary {
+        int line_id;
+        long forward;                   // crossings from left to right side of line within window
+        long backward;
+    };
+
+    struct cvedix_ba_zone_summary {
+        int zone_id;
+        long jams;                      // jam results within window
+        long stops;                     // stop results within window
+        long others;                    // other results within window
+        long involved;                  // targets involved in those results
+        int max_involved;               // most targets involved in one result within window
+    };
+
+    // compact summary of one channel over the sliding window
+    struct cvedix_ba_summary {
+        int channel_index = -1;
+        double timestamp = 0;           // seconds, time of summary
+        double window_seconds = 0;
+        std::vector<cvedix_ba_line_summary> lines;
+        std::vector<cvedix_ba_zone_summary> zones;
+
+        std::string to_json() const {
+            std::stringstream ss;
+            ss << "{\"channel_index\":" << channel_index << ",\"timestamp\":" << timestamp << ",\"window_seconds\":" << window_seconds << ",\"lines\":[";
+            for (size_t i = 0; i < lines.size(); i++) {
+                auto& l = lines[i];
+                ss << (i ? "," : "") << "{\"line_id\":" << l.line_id << ",\"forward\":" << l.forward << ",\"backward\":" << l.backward << "}";
+            }
+            ss << "],\"zones\":[";
+            for (size_t i = 0; i < zones.size(); i++) {
+                auto& z = zones[i];
+                ss << (i ? "," : "") << "{\"zone_id\":" << z.zone_id << ",\"jams\":" << z.jams << ",\"stops\":" << z.stops
+                   << ",\"others\":" << z.others << ",\"involved\":" << z.involved << ",\"max_involved\":" << z.max_involved << "}";
+            }
+            ss << "]}";
+            return ss.str();
+        }
+    };
+
+    // sliding-window counters of one channel in fixed memory.
+    // everything is kept per time bucket in ring buffers sized at construction (lines x buckets, zones x buckets),
+    // advancing time clears expired buckets, so memory and cost of summarize(...) do not depend on event rate.
+    // time is any clock in seconds (stream time or wall clock), events slightly older than the latest one are counted
+    // into the current bucket.
+    // not thread-safe.
+    class cvedix_ba_aggregator {
+    private:
+        cvedix_ba_aggregator_config config;
+        int line_count;
+        int zone_count;
+        int64_t current_bucket = -1;
+
+        std::vector<uint32_t> forward, backward;            // [bucket][line]
+        std::vector<uint32_t> jams, stops, others;          // [bucket][zone]
+        std::vector<uint32_t> involved, max_involved;       // [bucket][zone]
+
+        int slot(int64_t bucket) const {
+            return static_cast<int>(bucket % config.window_buckets);
+        }
+
+        void clear_slot(int s) {
+            std::fill_n(forward.begin() + s * line_count, line_count, 0);
+            std::fill_n(backward.begin() + s * line_count, line_count, 0);
+            for (auto counts: {&jams, &stops, &others, &involved, &max_involved}) {
+                std::fill_n(counts->begin() + s * zone_count, zone_count, 0);
+            }
+        }
+
+        // move window to `now`, return slot of current bucket
+        int advance(double now) {
+            auto bucket = static_cast<int64_t>(std::floor(now / config.bucket_seconds));
+            if (current_bucket < 0) {
+                current_bucket = bucket;
+                return slot(bucket);
+            }
+            // buckets between last update and now expired (at most the whole ring)
+            auto steps = std::min<int64_t>(bucket - current_bucket, config.window_buckets);
+            for (int64_t b = 1; b <= steps; b++) {
+                clear_slot(slot(current_bucket + b));
+            }
+            current_bucket = std::max(current_bucket, bucket);
+            return slot(current_bucket);
+        }
+
+    public:
+        cvedix_ba_aggregator(int line_count, int zone_count, const cvedix_ba_aggregator_config& config = cvedix_ba_aggregator_config()):
+                             config(config), line_count(line_count), zone_count(zone_count) {
+            this->config.window_buckets = std::max(1, this->config.window_buckets);
+            auto w = this->config.window_buckets;
+            forward.assign(w * line_count, 0);
+            backward.assign(w * line_count, 0);
+            for (auto counts: {&jams, &stops, &others, &involved, &max_involved}) {
+                counts->assign(w * zone_count, 0);
+            }
+        }
+
+        // direction > 0 is forward
+        void add_crossing(int line_id, int direction, double now) {
+            if (line_id < 0 || line_id >= line_count) {
+                return;
+            }
+            auto s = advance(now);
+            (direction > 0 ? forward : backward)[s * line_count + line_id]++;
+        }
+
+        // one result of a region based ba node, `involved_targets` targets involved in it
+        void add_zone_event(int zone_id, cvedix_ba_zone_event event, int involved_targets, double now) {
+            if (zone_id < 0 || zone_id >= zone_count) {
+                return;
+            }
+            auto i = advance(now) * zone_count + zone_id;
+            auto& counts = event == cvedix_ba_zone_event::JAM ? jams : event == cvedix_ba_zone_event::STOP ? stops : others;
+            counts[i]++;
+            involved[i] += std::max(0, involved_targets);
+            max_involved[i] = std::max<uint32_t>(max_involved[i], std::max(0, involved_targets));
+        }
+
+        cvedix_ba_summary summarize(int channel_index, double now) {
+            advance(now);
+            cvedix_ba_summary summary;
+            summary.channel_index = channel_index;
+            summary.timestamp = now;
+            summary.window_seconds = config.bucket_seconds * config.window_buckets;
+            auto w = config.window_buckets;
+
+            for (int l = 0; l < line_count; l++) {
+                cvedix_ba_line_summary line {l, 0, 0};
+                for (int s = 0; s < w; s++) {
+                    line.forward += forward[s * line_count + l];
+                    line.backward += backward[s * line_count + l];
+                }
+                summary.lines.push_back(line);
+            }
+            for (int z = 0; z < zone_count; z++) {
+                cvedix_ba_zone_summary zone {z, 0, 0, 0, 0, 0};
+                for (int s = 0; s < w; s++) {
+                    auto i = s * zone_count + z;
+                    zone.jams += jams[i];
+                    zone.stops += stops[i];
+                    zone.others += others[i];
+                    zone.involved += involved[i];
+                    zone.max_involved = std::max<int>(zone.max_involved, max_involved[i]);
+                }
+                summary.zones.push_back(zone);
+            }
+            return summary;
+        }
+    };
+}
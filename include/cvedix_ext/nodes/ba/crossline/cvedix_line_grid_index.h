@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace cvedix_nodes {
+    struct cvedix_line_segment {
+        float x1 = 0, y1 = 0;
+        float x2 = 0, y2 = 0;
+    };
+
+    // one crossing found by cvedix_line_grid_index::cross(...)
+    struct cvedix_line_crossing {
+        int line_id;        // index of line in the vector passed to index
+        int direction;      // 1 if moved from left side to right side of line (start -> end, image coordinates), -1 otherwise
+    };
+
+    // uniform grid over counting lines.
+    // every line is registered in the cells it passes through once, a movement (previous -> current track point) only
+    // tests lines registered in the cells covered by the movement. movements are short compared to the frame, so the
+    // cost per track is O(lines nearby) instead of O(all lines).
+    class cvedix_line_grid_index {
+    private:
+        std::vector<cvedix_line_segment> lines;
+        float x0 = 0, y0 = 0, cell_size = 64;
+        int grid_w = 0, grid_h = 0;
+        // CSR: cell -> [cell_start[cell], cell_start[cell + 1]) in cell_lines
+        std::vector<int> cell_start;
+        std::vector<int> cell_lines;
+        std::vector<int> visit_stamp;
+        int stamp = 0;
+
+        static float cross_product(float ax, float ay, float bx, float by) {
+            return ax * by - ay * bx;
+        }
+
+        void cell_range(float ax, float ay, float bx, float by, int& cx0, int& cy0, int& cx1, int& cy1) const {
+            cx0 = std::max(0, static_cast<int>(std::floor((std::min(ax, bx) - x0) / cell_size)));
+            cy0 = std::max(0, static_cast<int>(std::floor((std::min(ay, by) - y0) / cell_size)));
+            cx1 = std::min(grid_w - 1, static_cast<int>(std::floor((std::max(ax, bx) - x0) / cell_size)));
+            cy1 = std::min(grid_h - 1, static_cast<int>(std::floor((std::max(ay, by) - y0) / cell_size)));
+        }
+
+    public:
+        cvedix_line_grid_index() = default;
+
+        // cell_size <= 0 picks a size from line lengths
+        cvedix_line_grid_index(const std::vector<cvedix_line_segment>& lines, float cell_size = 0): lines(lines) {
+            if (lines.empty()) {
+                return;
+            }
+            float x1 = lines[0].x1, y1 = lines[0].y1;
+            x0 = x1;
+            y0 = y1;
+            double length_sum = 0;
+            for (auto& l: lines) {
+                x0 = std::min({x0, l.x1, l.x2});
+                y0 = std::min({y0, l.y1, l.y2});
+                x1 = std::max({x1, l.x1, l.x2});
+                y1 = std::max({y1, l.y1, l.y2});
+                length_sum += std::hypot(l.x2 - l.x1, l.y2 - l.y1);
+            }
+            // a quarter of average line length, clamped to [16, 256] pixels
+            this->cell_size = cell_size > 0 ? cell_size : std::min(256.0f, std::max(16.0f, static_cast<float>(length_sum / lines.size() / 4)));
+            grid_w = static_cast<int>((x1 - x0) / this->cell_size) + 1;
+            grid_h = static_cast<int>((y1 - y0) / this->cell_size) + 1;
+
+            // cells whose center is within half a diagonal of the line and inside its bounding box (conservative)
+            auto half_diagonal = this->cell_size * 0.70711f;
+            auto for_cells = [&](const cvedix_line_segment& l, auto&& func) {
+                int cx0, cy0, cx1, cy1;
+                cell_range(l.x1, l.y1, l.x2, l.y2, cx0, cy0, cx1, cy1);
+                auto dx = l.x2 - l.x1, dy = l.y2 - l.y1;
+                auto length = std::max(1e-6f, std::hypot(dx, dy));
+                for (int gy = cy0; gy <= cy1; gy++) {
+                    for (int gx = cx0; gx <= cx1; gx++) {
+                        auto cx = x0 + (gx + 0.5f) * this->cell_size;
+                        auto cy = y0 + (gy + 0.5f) * this->cell_size;
+                        if (std::fabs(cross_product(dx, dy, cx - l.x1, cy - l.y1)) / length <= half_diagonal) {
+                            func(gy * grid_w + gx);
+                        }
+                    }
+                }
+            };
+
+            cell_start.assign(grid_w * grid_h + 1, 0);
+            for (auto& l: lines) {
+                for_cells(l, [&](int cell) { cell_start[cell + 1]++; });
+            }
+            for (int c = 0; c < grid_w * grid_h; c++) {
+                cell_start[c + 1] += cell_start[c];
+            }
+            cell_lines.resize(cell_start.back());
+            std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+            for (size_t i = 0; i < lines.size(); i++) {
+                for_cells(lines[i], [&](int cell) { cell_lines[fill[cell]++] = static_cast<int>(i); });
+            }
+            visit_stamp.assign(lines.size(), -1);
+        }
+
+        // exact test of movement (ax, ay) -> (bx, by) against one line, 0 if not crossed
+        static int crossing_direction(const cvedix_line_segment& l, float ax, float ay, float bx, float by) {
+            auto dx = l.x2 - l.x1, dy = l.y2 - l.y1;
+            auto side_a = cross_product(dx, dy, ax - l.x1, ay - l.y1);
+            auto side_b = cross_product(dx, dy, bx - l.x1, by - l.y1);
+            // must move from one side strictly to the other side (or onto the line), leaving the line is not counted
+            if (side_a == 0 || ((side_a > 0) == (side_b > 0) && side_b != 0)) {
+                return 0;
+            }
+            auto mx = bx - ax, my = by - ay;
+            auto side_1 = cross_product(mx, my, l.x1 - ax, l.y1 - ay);
+            auto side_2 = cross_product(mx, my, l.x2 - ax, l.y2 - ay);
+            if ((side_1 > 0 && side_2 > 0) || (side_1 < 0 && side_2 < 0)) {
+                return 0;
+            }
+            return side_a < 0 ? 1 : -1;
+        }
+
+        // append all lines crossed by movement (ax, ay) -> (bx, by). not thread-safe (uses internal stamps).
+        void cross(float ax, float ay, float bx, float by, std::vector<cvedix_line_crossing>& crossings) {
+            if (grid_w == 0) {
+                return;
+            }
+            int cx0, cy0, cx1, cy1;
+            cell_range(ax, ay, bx, by, cx0, cy0, cx1, cy1);
+            stamp++;
+            for (int gy = cy0; gy <= cy1; gy++) {
+                for (int gx = cx0; gx <= cx1; gx++) {
+                    auto cell = gy * grid_w + gx;
+                    for (int k = cell_start[cell]; k < cell_start[cell + 1]; k++) {
+                        auto line_id = cell_lines[k];
+                        if (visit_stamp[line_id] == stamp) {
+                            continue;
+                        }
+                        visit_stamp[line_id] = stamp;
+                        auto direction = crossing_direction(lines[line_id], ax, ay, bx, by);
+                        if (direction != 0) {
+                            crossings.push_back({line_id, direction});
+                        }
+                    }
+                }
+            }
+        }
+
+        const std::vector<cvedix_line_segment>& get_lines() const {
+            return lines;
+        }
+    };
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "cvedix/nodes/cvedix_node.h"
+#include "cvedix_ext/nodes/ba/aggregate/cvedix_ba_aggregator.h"
+#include "cvedix_ext/nodes/ba/cvedix_ba_multi_crossline_node.h"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace cvedix_nodes {
+    // called on node's thread every summary interval, once per channel
+    typedef std::function<void(std::string, const cvedix_ba_summary&)> cvedix_ba_summary_hooker;
+
+    // streaming aggregates of behaviour analysis instead of per-event messages.
+    // the node adds up the ba results upstream ba nodes wrote into the frame meta, it does no geometry of its own. per
+    // channel it keeps sliding-window line counts with direction split and per-zone counts of jam/stop (and other
+    // region based) results in fixed memory (cvedix_ba_aggregator), and emits one compact cvedix_ba_summary every
+    // `summary_interval` seconds through the hooker.
+    //
+    // lines: CROSSLINE results of cvedix_ba_multi_crossline_node carry line id and direction in their label, results
+    // of cvedix_ba_crossline_node (one line per channel) count as forward crossings of line 0.
+    // zones: results of cvedix_ba_jam_node, cvedix_ba_stop_node, ... are assigned to the zone whose polygon equals
+    // the region of the result, so pass the same regions (same order) the ba nodes got. results of other regions are
+    // not counted.
+    // attach after the ba nodes, time is stream time (frame_index / fps), frame meta passes through unchanged.
+    class cvedix_ba_aggregate_node: public cvedix_node {
+    private:
+        struct channel_state {
+            std::unique_ptr<cvedix_ba_aggregator> aggregator;
+            std::vector<std::vector<cvedix_objects::cvedix_point>> zones;
+            double last_summary = -1;
+        };
+
+        std::map<int, channel_state> channels;
+        double summary_interval;
+        cvedix_ba_summary_hooker summary_hooker;
+
+        static double stream_time(const std::shared_ptr<cvedix_objects::cvedix_frame_meta>& meta) {
+            return meta->frame_index / (meta->fps > 0 ? static_cast<double>(meta->fps) : 25.0);
+        }
+
+        static int zone_of(const channel_state& channel, const std::vector<cvedix_objects::cvedix_point>& region) {
+            for (size_t z = 0; z < channel.zones.size(); z++) {
+                auto& zone = channel.zones[z];
+                if (zone.size() == region.size() &&
+                    std::equal(zone.begin(), zone.end(), region.begin(), [](const cvedix_objects::cvedix_point& a, const cvedix_objects::cvedix_point& b) {
+                        return a.x == b.x && a.y == b.y;
+                    })) {
+                    return static_cast<int>(z);
+                }
+            }
+            return -1;
+        }
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            auto it = channels.find(meta->channel_index);
+            if (it == channels.end()) {
+                return meta;
+            }
+            auto& channel = it->second;
+            auto now = stream_time(meta);
+
+            for (auto& result: meta->ba_results) {
+                if (result->type == cvedix_objects::cvedix_ba_type::CROSSLINE) {
+                    int line_id = 0, direction = 1;
+                    cvedix_parse_crossline_label(result->ba_label, line_id, direction);
+                    channel.aggregator->add_crossing(line_id, direction, now);
+                    continue;
+                }
+                auto zone = zone_of(channel, result->involve_region_in_frame);
+                if (zone < 0) {
+                    continue;
+                }
+                auto event = result->type == cvedix_objects::cvedix_ba_type::JAM ? cvedix_ba_zone_event::JAM :
+                             result->type == cvedix_objects::cvedix_ba_type::STOP ? cvedix_ba_zone_event::STOP : cvedix_ba_zone_event::OTHER;
+                channel.aggregator->add_zone_event(zone, event, static_cast<int>(result->involve_target_ids_in_frame.size()), now);
+            }
+
+            if (channel.last_summary < 0) {
+                channel.last_summary = now;
+            }
+            else if (now - channel.last_summary >= summary_interval) {
+                channel.last_summary = now;
+                auto summary = channel.aggregator->summarize(meta->channel_index, now);
+                if (summary_hooker) {
+                    summary_hooker(node_name, summary);
+                }
+            }
+            return meta;
+        }
+
+    public:
+        // zones: channel -> zone polygons as given to the ba nodes (zone id is index), lines_per_channel: channel -> number of counting lines
+        cvedix_ba_aggregate_node(std::string node_name,
+                                 std::map<int, std::vector<std::vector<cvedix_objects::cvedix_point>>> zones,
+                                 std::map<int, int> lines_per_channel = {},
+                                 double summary_interval = 10,
+                                 cvedix_ba_aggregator_config config = cvedix_ba_aggregator_config()):
+                                 cvedix_node(node_name),
+                                 summary_interval(summary_interval) {
+            std::map<int, bool> all_channels;
+            for (auto& z: zones) all_channels[z.first] = true;
+            for (auto& l: lines_per_channel) all_channels[l.first] = true;
+
+            for (auto& [channel_index, _]: all_channels) {
+                auto& channel = channels[channel_index];
+                if (zones.count(channel_index)) {
+                    channel.zones = zones[channel_index];
+                }
+                auto lines = lines_per_channel.count(channel_index) ? lines_per_channel[channel_index] : 0;
+                channel.aggregator = std::make_unique<cvedix_ba_aggregator>(lines, channel.zones.size(), config);
+            }
+            this->initialized();
+        }
+        ~cvedix_ba_aggregate_node() = default;
+
+        // set before pipeline starts
+        void set_summary_hooker(cvedix_ba_summary_hooker hooker) {
+            summary_hooker = hooker;
+        }
+    };
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "cvedix/nodes/cvedix_node.h"
+#include "cvedix_ext/nodes/ba/crossline/cvedix_line_grid_index.h"
+
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cvedix_nodes {
+    // one target crossed one line
+    struct cvedix_crossline_event {
+        int channel_index;
+        int frame_index;
+        double timestamp;   // stream time in seconds (frame_index / fps)
+        int line_id;        // index of line in the vector configured for channel
+        int track_id;
+        int direction;      // 1 if moved from left side to right side of line (start -> end, image coordinates), -1 otherwise
+        int class_id;
+        std::string label;
+    };
+
+    // label of CROSSLINE ba results written by cvedix_ba_multi_crossline_node, "line <id> forward|backward"
+    inline std::string cvedix_crossline_label(int line_id, int direction) {
+        return "line " + std::to_string(line_id) + (direction > 0 ? " forward" : " backward");
+    }
+
+    // line id and direction from a label of cvedix_crossline_label(...), false for other labels
+    inline bool cvedix_parse_crossline_label(const std::string& label, int& line_id, int& direction) {
+        char word[16] = {0};
+        if (std::sscanf(label.c_str(), "line %d %15s", &line_id, word) != 2) {
+            return false;
+        }
+        direction = std::string(word) == "forward" ? 1 : -1;
+        return true;
+    }
+
+    // called on node's thread for every crossing
+    typedef std::function<void(std::string, const cvedix_crossline_event&)> cvedix_crossline_hooker;
+
+    // counting on many lines per channel (30-60 lines at intersections, hundreds of tracks).
+    // cvedix_ba_crossline_node takes one line per channel and tests every track against it, this node takes any number
+    // of lines per channel and puts them into a cvedix_line_grid_index, so each track movement only tests lines nearby.
+    // a movement is the bottom center of the last 2 rects in target->tracks, so it MUST be attached after a track node.
+    // every crossing is written into meta->ba_results as a CROSSLINE result the way cvedix_ba_crossline_node does
+    // (track id of the target, start/end of the line, label "line <id> forward|backward"), so ba osd, broker and
+    // record nodes downstream handle it as usual. crossings are also reported by hooker and per-line counters.
+    class cvedix_ba_multi_crossline_node: public cvedix_node {
+    private:
+        // channel -> index over lines of channel
+        std::map<int, cvedix_line_grid_index> indexes;
+        // channel -> lines, for regions of ba results
+        std::map<int, std::vector<cvedix_objects::cvedix_line>> lines;
+        // channel -> line -> {forward, backward}
+        std::map<int, std::vector<std::pair<long, long>>> counts;
+        std::mutex counts_lock;
+        cvedix_crossline_hooker crossline_hooker;
+
+        std::vector<cvedix_line_crossing> crossings;
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            auto it = indexes.find(meta->channel_index);
+            if (it == indexes.end()) {
+                return meta;
+            }
+            auto& index = it->second;
+            auto& channel_lines = lines[meta->channel_index];
+
+            for (auto& target: meta->targets) {
+                if (target->track_id < 0 || target->tracks.size() < 2) {
+                    continue;
+                }
+                auto& prev = target->tracks[target->tracks.size() - 2];
+                auto& cur = target->tracks.back();
+                crossings.clear();
+                index.cross(prev.x + prev.width / 2.0f, prev.y + prev.height,
+                            cur.x + cur.width / 2.0f, cur.y + cur.height, crossings);
+                if (crossings.empty()) {
+                    continue;
+                }
+
+                for (auto& c: crossings) {
+                    auto& line = channel_lines[c.line_id];
+                    meta->ba_results.push_back(std::make_shared<cvedix_objects::cvedix_ba_result>(
+                        cvedix_objects::cvedix_ba_type::CROSSLINE, meta->channel_index, meta->frame_index, std::vector<int>{target->track_id},
+                        std::vector<cvedix_objects::cvedix_point>{line.start, line.end}, cvedix_crossline_label(c.line_id, c.direction)));
+                }
+                {
+                    std::lock_guard<std::mutex> guard(counts_lock);
+                    auto& channel_counts = counts[meta->channel_index];
+                    for (auto& c: crossings) {
+                        if (c.direction > 0) {
+                            channel_counts[c.line_id].first++;
+                        }
+                        else {
+                            channel_counts[c.line_id].second++;
+                        }
+                    }
+                }
+                if (crossline_hooker) {
+                    for (auto& c: crossings) {
+                        auto timestamp = meta->frame_index / (meta->fps > 0 ? static_cast<double>(meta->fps) : 25.0);
+                        crossline_hooker(node_name, {meta->channel_index, meta->frame_index, timestamp, c.line_id, target->track_id,
+                                                     c.direction, target->primary_class_id, target->primary_label});
+                    }
+                }
+            }
+            return meta;
+        }
+
+    public:
+        // channel -> lines, cell_size <= 0 picks grid cell size from line lengths
+        cvedix_ba_multi_crossline_node(std::string node_name,
+                                       std::map<int, std::vector<cvedix_objects::cvedix_line>> lines,
+                                       float cell_size = 0):
+                                       cvedix_node(node_name),
+                                       lines(lines) {
+            for (auto& [channel_index, channel_lines]: lines) {
+                std::vector<cvedix_line_segment> segments;
+                for (auto& l: channel_lines) {
+                    segments.push_back({static_cast<float>(l.start.x), static_cast<float>(l.start.y),
+                                        static_cast<float>(l.end.x), static_cast<float>(l.end.y)});
+                }
+                indexes.emplace(channel_index, cvedix_line_grid_index(segments, cell_size));
+                counts[channel_index].assign(segments.size(), {0, 0});
+            }
+            this->initialized();
+        }
+        ~cvedix_ba_multi_crossline_node() = default;
+
+        // set before pipeline starts
+        void set_crossline_hooker(cvedix_crossline_hooker hooker) {
+            crossline_hooker = hooker;
+        }
+
+        // {forward, backward} count of each line of channel since start, thread-safe
+        std::vector<std::pair<long, long>> get_counts(int channel_index) {
+            std::lock_guard<std::mutex> guard(counts_lock);
+            auto it = counts.find(channel_index);
+            return it == counts.end() ? std::vector<std::pair<long, long>>() : it->second;
+        }
+    };
+}
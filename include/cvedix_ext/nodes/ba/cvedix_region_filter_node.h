@@ -0,0 +1,197 @@
+#pragma once
+
+#include "cvedix/nodes/cvedix_node.h"
+#include "cvedix_ext/nodes/ba/region/cvedix_region_mask.h"
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cvedix_nodes {
+    // targets hidden by a cvedix_region_filter_node until its cvedix_region_restore_node puts them back, per frame
+    class cvedix_region_filter_stash {
+    private:
+        struct entry {
+            std::weak_ptr<cvedix_objects::cvedix_frame_meta> meta;
+            // original position -> target
+            std::vector<std::pair<size_t, std::shared_ptr<cvedix_objects::cvedix_frame_target>>> hidden;
+        };
+        // frames between the 2 nodes, oldest first. an entry lives as long as its meta: frames the ba node falls
+        // behind on are still queued (alive) and keep theirs, entries of frames dropped on the way expire
+        std::deque<entry> entries;
+        std::mutex lock;
+
+        static bool same(const std::weak_ptr<cvedix_objects::cvedix_frame_meta>& w, const std::shared_ptr<cvedix_objects::cvedix_frame_meta>& meta) {
+            return !w.owner_before(meta) && !meta.owner_before(w);
+        }
+
+    public:
+        void put(const std::shared_ptr<cvedix_objects::cvedix_frame_meta>& meta,
+                 std::vector<std::pair<size_t, std::shared_ptr<cvedix_objects::cvedix_frame_target>>>&& hidden) {
+            std::lock_guard<std::mutex> guard(lock);
+            entries.erase(std::remove_if(entries.begin(), entries.end(), [](const entry& e) {
+                return e.meta.expired();
+            }), entries.end());
+            entries.push_back({meta, std::move(hidden)});
+        }
+
+        // empty if nothing was hidden for the meta
+        std::vector<std::pair<size_t, std::shared_ptr<cvedix_objects::cvedix_frame_target>>> take(const std::shared_ptr<cvedix_objects::cvedix_frame_meta>& meta) {
+            std::lock_guard<std::mutex> guard(lock);
+            for (auto e = entries.begin(); e != entries.end(); e++) {
+                if (same(e->meta, meta)) {
+                    auto hidden = std::move(e->hidden);
+                    entries.erase(e);
+                    return hidden;
+                }
+            }
+            return {};
+        }
+    };
+
+    // hide targets outside the regions of their channel from the next node, decided by one lookup in a rasterized
+    // cvedix_region_mask (bottom center of target rect). meant to sit right in front of cvedix_ba_jam_node/
+    // cvedix_ba_stop_node (after the track node) with the same regions, so the ba node only runs its polygon test on
+    // targets which can be in its region. only targets certainly outside are hidden, targets in border cells of the
+    // mask pass to the ba node's exact test, so the ba result is the same as without the filter.
+    // a cvedix_region_restore_node right after the ba node (see make_restore_node()) puts hidden targets back at
+    // their original positions, so osd, recorder and broker nodes downstream still see every target. channels
+    // without regions pass through untouched.
+    //
+    // limits: the sdk ba node still runs its own polygon test per kept target (the filter removes the tests of
+    // targets far outside, it does not replace the test), and the pair adds 2 node hops per frame, so it pays off
+    // with many targets outside small regions only.
+    // regions can be replaced at runtime by update_regions(...) without rebuilding the pipeline, the change applies
+    // from the next frame. the ba node after this node still applies its own (construction time) region, so at
+    // runtime regions can be narrowed or disabled, not extended beyond the ba node's region.
+    //
+    // usage:
+    // auto region_filter = std::make_shared<cvedix_region_filter_node>("region_filter", regions);
+    // auto region_restore = region_filter->make_restore_node("region_restore");
+    // region_filter->attach_to({tracker}); ba_jam->attach_to({region_filter}); region_restore->attach_to({ba_jam});
+    class cvedix_region_filter_node: public cvedix_node {
+    private:
+        std::shared_ptr<cvedix_region_mask_board> board;
+        std::shared_ptr<cvedix_region_filter_stash> stash;
+        int cell_size;
+
+        static cvedix_region_polygon to_polygon(const std::vector<cvedix_objects::cvedix_point>& points) {
+            cvedix_region_polygon polygon;
+            for (auto& p: points) {
+                polygon.push_back({static_cast<float>(p.x), static_cast<float>(p.y)});
+            }
+            return polygon;
+        }
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            // one snapshot per frame
+            auto mask = board->get(meta->channel_index);
+            if (!mask) {
+                return meta;
+            }
+            auto& targets = meta->targets;
+            std::vector<std::pair<size_t, std::shared_ptr<cvedix_objects::cvedix_frame_target>>> hidden;
+            size_t kept = 0;
+            for (size_t i = 0; i < targets.size(); i++) {
+                auto& t = targets[i];
+                // hide certain misses only, unknown (border) targets go to the ba node's exact test
+                if (mask->region_at(t->x + t->width / 2.0f, t->y + t->height) == -1) {
+                    hidden.emplace_back(i, t);
+                }
+                else {
+                    targets[kept++] = t;
+                }
+            }
+            if (!hidden.empty()) {
+                targets.resize(kept);
+                stash->put(meta, std::move(hidden));
+            }
+            return meta;
+        }
+
+    public:
+        // channel -> region, same as cvedix_ba_jam_node/cvedix_ba_stop_node. cell_size is pixel size of mask cell.
+        cvedix_region_filter_node(std::string node_name,
+                                  std::map<int, std::vector<cvedix_objects::cvedix_point>> regions,
+                                  int cell_size = 4):
+                                  cvedix_node(node_name),
+                                  board(std::make_shared<cvedix_region_mask_board>()),
+                                  stash(std::make_shared<cvedix_region_filter_stash>()),
+                                  cell_size(cell_size) {
+            for (auto& [channel_index, points]: regions) {
+                board->set_regions(channel_index, {to_polygon(points)}, cell_size);
+            }
+            this->initialized();
+        }
+        ~cvedix_region_filter_node() = default;
+
+        // replace regions of a channel while running (empty means no filter for the channel), thread-safe
+        void update_regions(int channel_index, const std::vector<std::vector<cvedix_objects::cvedix_point>>& regions) {
+            if (regions.empty()) {
+                board->remove_regions(channel_index);
+                return;
+            }
+            std::vector<cvedix_region_polygon> polygons;
+            for (auto& points: regions) {
+                polygons.push_back(to_polygon(points));
+            }
+            board->set_regions(channel_index, polygons, cell_size);
+        }
+
+        // region id lookups for other nodes/hookers sharing the same regions
+        std::shared_ptr<cvedix_region_mask_board> get_region_board() {
+            return board;
+        }
+
+        std::shared_ptr<cvedix_region_filter_stash> get_stash() {
+            return stash;
+        }
+
+        // node which puts targets hidden by this node back, attach it right after the ba node
+        std::shared_ptr<cvedix_node> make_restore_node(std::string node_name);
+    };
+
+    // second half of cvedix_region_filter_node: merges hidden targets back into meta->targets at their original positions
+    class cvedix_region_restore_node: public cvedix_node {
+    private:
+        std::shared_ptr<cvedix_region_filter_stash> stash;
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            auto hidden = stash->take(meta);
+            if (hidden.empty()) {
+                return meta;
+            }
+            auto& targets = meta->targets;
+            std::vector<std::shared_ptr<cvedix_objects::cvedix_frame_target>> merged;
+            merged.reserve(targets.size() + hidden.size());
+            size_t next_kept = 0;
+            for (auto& [position, target]: hidden) {
+                while (merged.size() < position && next_kept < targets.size()) {
+                    merged.push_back(targets[next_kept++]);
+                }
+                merged.push_back(target);
+            }
+            merged.insert(merged.end(), targets.begin() + next_kept, targets.end());
+            targets.swap(merged);
+            return meta;
+        }
+
+    public:
+        cvedix_region_restore_node(std::string node_name, std::shared_ptr<cvedix_region_filter_stash> stash):
+                                   cvedix_node(node_name),
+                                   stash(stash) {
+            this->initialized();
+        }
+        ~cvedix_region_restore_node() = default;
+    };
+
+    inline std::shared_ptr<cvedix_node> cvedix_region_filter_node::make_restore_node(std::string node_name) {
+        return std::make_shared<cvedix_region_restore_node>(node_name, stash);
+    }
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cvedix_nodes {
+    struct cvedix_region_vertex {
+        float x = 0;
+        float y = 0;
+    };
+    typedef std::vector<cvedix_region_vertex> cvedix_region_polygon;
+
+    // polygon regions rasterized once into a downscaled label grid (region id per cell of cell_size x cell_size
+    // pixels), so membership of a point is one lookup instead of a point-in-polygon test per region.
+    // the grid only covers the bounding box of all regions, points outside it are in no region.
+    // cells crossed by any polygon edge are `unknown`: points in them may be on either side, callers needing the
+    // exact answer run their own polygon test for those (a few cells along the borders). every other cell lies
+    // entirely inside or outside each polygon, so its label is exact (even-odd rule, regions with lower id win
+    // where they overlap).
+    class cvedix_region_mask {
+    public:
+        static constexpr int16_t unknown = -2;
+
+    private:
+        int cell_size;
+        float x0 = 0, y0 = 0;
+        int grid_w = 0, grid_h = 0;
+        int regions = 0;
+        std::vector<int16_t> labels;
+
+        void rasterize(const cvedix_region_polygon& polygon, int16_t id) {
+            std::vector<float> xs;
+            for (int row = 0; row < grid_h; row++) {
+                auto y = y0 + (row + 0.5f) * cell_size;
+                xs.clear();
+                for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+                    auto& a = polygon[i];
+                    auto& b = polygon[j];
+                    if ((a.y <= y && y < b.y) || (b.y <= y && y < a.y)) {
+                        xs.push_back(a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y));
+                    }
+                }
+                std::sort(xs.begin(), xs.end());
+                for (size_t k = 0; k + 1 < xs.size(); k += 2) {
+                    // cells whose center x is in [xs[k], xs[k + 1])
+                    auto first = std::max(0, static_cast<int>(std::ceil((xs[k] - x0) / cell_size - 0.5f)));
+                    auto last = std::min(grid_w - 1, static_cast<int>(std::ceil((xs[k + 1] - x0) / cell_size - 0.5f)) - 1);
+                    auto line = labels.data() + row * grid_w;
+                    for (int col = first; col <= last; col++) {
+                        if (line[col] < 0) {
+                            line[col] = id;
+                        }
+                    }
+                }
+            }
+        }
+
+        // closed segment against closed box (liang-barsky)
+        static bool segment_hits_box(const cvedix_region_vertex& a, const cvedix_region_vertex& b,
+                                     float x_min, float y_min, float x_max, float y_max) {
+            float dx = b.x - a.x, dy = b.y - a.y;
+            float p[4] = {-dx, dx, -dy, dy};
+            float q[4] = {a.x - x_min, x_max - a.x, a.y - y_min, y_max - a.y};
+            float t0 = 0, t1 = 1;
+            for (int k = 0; k < 4; k++) {
+                if (p[k] == 0) {
+                    if (q[k] < 0) return false;
+                    continue;
+                }
+                auto t = q[k] / p[k];
+                if (p[k] < 0) t0 = std::max(t0, t);
+                else t1 = std::min(t1, t);
+                if (t0 > t1) return false;
+            }
+            return true;
+        }
+
+        // mark cells touched by polygon edges as unknown, after all regions are rasterized
+        void mark_borders(const cvedix_region_polygon& polygon) {
+            const float margin = 0.01f;     // float rounding of cell bounds
+            for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+                auto& a = polygon[i];
+                auto& b = polygon[j];
+                auto col0 = std::max(0, static_cast<int>(std::floor((std::min(a.x, b.x) - x0) / cell_size)) - 1);
+                auto col1 = std::min(grid_w - 1, static_cast<int>(std::floor((std::max(a.x, b.x) - x0) / cell_size)) + 1);
+                auto row0 = std::max(0, static_cast<int>(std::floor((std::min(a.y, b.y) - y0) / cell_size)) - 1);
+                auto row1 = std::min(grid_h - 1, static_cast<int>(std::floor((std::max(a.y, b.y) - y0) / cell_size)) + 1);
+                for (int row = row0; row <= row1; row++) {
+                    for (int col = col0; col <= col1; col++) {
+                        auto cx = x0 + col * cell_size;
+                        auto cy = y0 + row * cell_size;
+                        if (segment_hits_box(a, b, cx - margin, cy - margin, cx + cell_size + margin, cy + cell_size + margin)) {
+                            labels[row * grid_w + col] = unknown;
+                        }
+                    }
+                }
+            }
+        }
+
+    public:
+        cvedix_region_mask(const std::vector<cvedix_region_polygon>& polygons, int cell_size = 4):
+                           cell_size(std::max(1, cell_size)), regions(polygons.size()) {
+            bool first = true;
+            float x1 = 0, y1 = 0;
+            for (auto& polygon: polygons) {
+                for (auto& v: polygon) {
+                    x0 = first ? v.x : std::min(x0, v.x);
+                    y0 = first ? v.y : std::min(y0, v.y);
+                    x1 = first ? v.x : std::max(x1, v.x);
+                    y1 = first ? v.y : std::max(y1, v.y);
+                    first = false;
+                }
+            }
+            if (first) {
+                return;
+            }
+            grid_w = static_cast<int>((x1 - x0) / this->cell_size) + 1;
+            grid_h = static_cast<int>((y1 - y0) / this->cell_size) + 1;
+            labels.assign(grid_w * grid_h, -1);
+            for (size_t i = 0; i < polygons.size(); i++) {
+                if (polygons[i].size() >= 3) {
+                    rasterize(polygons[i], static_cast<int16_t>(i));
+                }
+            }
+            for (auto& polygon: polygons) {
+                if (polygon.size() >= 3) {
+                    mark_borders(polygon);
+                }
+            }
+        }
+
+        // id of region containing (x, y) (index in polygons), -1 if none, unknown if (x, y) is near a region border
+        int region_at(float x, float y) const {
+            auto col = static_cast<int>(std::floor((x - x0) / cell_size));
+            auto row = static_cast<int>(std::floor((y - y0) / cell_size));
+            if (col < 0 || row < 0 || col >= grid_w || row >= grid_h) {
+                return -1;
+            }
+            return labels[row * grid_w + col];
+        }
+
+        int region_count() const {
+            return regions;
+        }
+    };
+
+    // region masks of all channels, replaceable at any time while pipeline is running.
+    // set_regions(...) builds the new mask on caller's thread and swaps it in, readers take a snapshot with get(...)
+    // once per frame and keep using it, so a frame is always evaluated against one consistent set of regions.
+    class cvedix_region_mask_board {
+    private:
+        std::map<int, std::shared_ptr<const cvedix_region_mask>> masks;
+        mutable std::mutex masks_lock;
+
+    public:
+        void set_regions(int channel_index, const std::vector<cvedix_region_polygon>& polygons, int cell_size = 4) {
+            auto mask = std::make_shared<const cvedix_region_mask>(polygons, cell_size);
+            std::lock_guard<std::mutex> guard(masks_lock);
+            masks[channel_index] = mask;
+        }
+
+        void remove_regions(int channel_index) {
+            std::lock_guard<std::mutex> guard(masks_lock);
+            masks.erase(channel_index);
+        }
+
+        // nullptr if no regions for channel
+        std::shared_ptr<const cvedix_region_mask> get(int channel_index) const {
+            std::lock_guard<std::mutex> guard(masks_lock);
+            auto it = masks.find(channel_index);
+            return it == masks.end() ? nullptr : it->second;
+        }
+    };
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "cvedix/nodes/des/cvedix_des_node.h"
+#include "cvedix/objects/cvedix_frame_meta.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cvedix_nodes {
+    // what the node's thread does when the result queue is full (host pulls slower than the pipeline produces)
+    enum class cvedix_app_des_overflow_policy {
+        DROP_OLDEST,    // discard the oldest queued result, host always sees the latest frames (live view)
+        DROP_NEWEST,    // discard the arriving result, queued ones are kept
+        BLOCK           // wait for room, backpressure to the whole pipeline, nothing is lost (offline processing)
+    };
+
+    // hand results (frame metas) to host code like cvedix_app_des_node, but pulled instead of pushed:
+    // the node's thread only appends the meta to a bounded queue, host code takes them on its own thread(s) with
+    // try_pop / pop / pop_batch. user code never runs on the pipeline thread, and a slow host costs dropped results
+    // (or backpressure with BLOCK) instead of a stalled pipeline. metas are delivered as cvedix_frame_meta, the
+    // node's typed handle_frame_meta(...) is used so no cast is needed on either side. control metas are not queued.
+    //
+    // usage:
+    // auto app_des_0 = std::make_shared<cvedix_app_des_node_v2>("app_des_0", 0, 8);
+    // while (...) {
+    //     for (auto& frame_meta: app_des_0->pop_batch(4, 100)) { ... }
+    // }
+    class cvedix_app_des_node_v2: public cvedix_des_node {
+    private:
+        size_t capacity;
+        cvedix_app_des_overflow_policy overflow_policy;
+        std::deque<std::shared_ptr<cvedix_objects::cvedix_frame_meta>> results;
+        std::mutex results_lock;
+        std::condition_variable results_changed;
+        bool closed = false;
+        std::atomic<uint64_t> dropped {0};
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            {
+                std::unique_lock<std::mutex> guard(results_lock);
+                if (results.size() >= capacity) {
+                    if (overflow_policy == cvedix_app_des_overflow_policy::BLOCK) {
+                        results_changed.wait(guard, [&]() { return closed || results.size() < capacity; });
+                    }
+                    else if (overflow_policy == cvedix_app_des_overflow_policy::DROP_OLDEST) {
+                        results.pop_front();
+                        dropped++;
+                    }
+                }
+                if (!closed && results.size() < capacity) {
+                    results.push_back(meta);
+                }
+                else if (overflow_policy == cvedix_app_des_overflow_policy::DROP_NEWEST) {
+                    dropped++;
+                }
+            }
+            results_changed.notify_all();
+            return cvedix_des_node::handle_frame_meta(meta);
+        }
+
+    public:
+        // capacity: results kept for host code, overflow_policy: what happens when host does not pull fast enough
+        cvedix_app_des_node_v2(std::string node_name,
+                               int channel_index,
+                               size_t capacity = 8,
+                               cvedix_app_des_overflow_policy overflow_policy = cvedix_app_des_overflow_policy::DROP_OLDEST):
+                               cvedix_des_node(node_name, channel_index),
+                               capacity(capacity > 0 ? capacity : 1),
+                               overflow_policy(overflow_policy) {
+            this->initialized();
+        }
+        ~cvedix_app_des_node_v2() {
+            // release a node's thread waiting for room (BLOCK) and host threads waiting for results
+            {
+                std::lock_guard<std::mutex> guard(results_lock);
+                closed = true;
+            }
+            results_changed.notify_all();
+            this->deinitialized();
+        }
+
+        // take the oldest result if there is one, never waits
+        bool try_pop(std::shared_ptr<cvedix_objects::cvedix_frame_meta>& result) {
+            return pop(result, 0);
+        }
+
+        // take the oldest result, waiting up to timeout_ms (-1 forever) for one
+        bool pop(std::shared_ptr<cvedix_objects::cvedix_frame_meta>& result, int timeout_ms) {
+            auto batch = pop_batch(1, timeout_ms);
+            if (batch.empty()) {
+                return false;
+            }
+            result = std::move(batch[0]);
+            return true;
+        }
+
+        // take up to max_count results in arrival order with one lock, waiting up to timeout_ms (-1 forever)
+        // for the first one. empty if nothing arrived in time
+        std::vector<std::shared_ptr<cvedix_objects::cvedix_frame_meta>> pop_batch(size_t max_count, int timeout_ms) {
+            std::vector<std::shared_ptr<cvedix_objects::cvedix_frame_meta>> batch;
+            {
+                std::unique_lock<std::mutex> guard(results_lock);
+                auto ready = [&]() { return closed || !results.empty(); };
+                if (timeout_ms < 0) {
+                    results_changed.wait(guard, ready);
+                }
+                else if (timeout_ms > 0) {
+                    results_changed.wait_for(guard, std::chrono::milliseconds(timeout_ms), ready);
+                }
+                auto n = std::min(max_count, results.size());
+                batch.reserve(n);
+                for (size_t i = 0; i < n; i++) {
+                    batch.push_back(std::move(results.front()));
+                    results.pop_front();
+                }
+            }
+            if (!batch.empty()) {
+                results_changed.notify_all();   // room for a node's thread waiting with BLOCK
+            }
+            return batch;
+        }
+
+        // results waiting to be pulled
+        size_t size() {
+            std::lock_guard<std::mutex> guard(results_lock);
+            return results.size();
+        }
+
+        // results discarded by DROP_OLDEST / DROP_NEWEST since start
+        uint64_t dropped_count() const {
+            return dropped;
+        }
+    };
+}
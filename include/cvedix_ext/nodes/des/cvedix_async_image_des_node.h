@@ -0,0 +1,120 @@
+#pragma once
+
+#include "cvedix/nodes/des/cvedix_des_node.h"
+#include "cvedix/nodes/record/cvedix_record_node.h"
+#include "cvedix/utils/cvedix_utils.h"
+#include "cvedix/utils/logger/cvedix_logger.h"
+#include "cvedix_ext/utils/cvedix_async_file_writer.h"
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <functional>
+#include <memory>
+
+namespace cvedix_nodes {
+    typedef std::function<void(int, cvedix_record_info)> cvedix_image_record_complete_hooker;
+
+    // save images to local files like cvedix_image_des_node ("./images/%d.jpg"), but jpeg encoding and disk writes
+    // run on the I/O thread of a cvedix_utils::cvedix_async_file_writer, the node's thread only takes a reference of
+    // the frame (and resizes it if needed). storage stalls show up as dropped images (or backpressure with
+    // cvedix_overflow_policy::BLOCK), not as a blocked pipeline.
+    // one writer can be shared by many nodes (all image/record outputs of a box on one I/O thread).
+    // completion is reported by set_image_record_complete_hooker(...) with a cvedix_record_info, like cvedix_record_node.
+    class cvedix_async_image_des_node: public cvedix_des_node {
+    private:
+        std::string location;
+        double interval;
+        cvedix_objects::cvedix_size resolution_w_h;
+        bool osd;
+        int jpeg_quality;
+        std::shared_ptr<cvedix_utils::cvedix_async_file_writer> writer;
+        cvedix_image_record_complete_hooker image_record_complete_hooker;
+
+        int file_index = 0;
+        double last_saved = -1;
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            auto now = meta->frame_index / (meta->fps > 0 ? static_cast<double>(meta->fps) : 25.0);
+            if (last_saved >= 0 && now - last_saved < interval) {
+                return cvedix_des_node::handle_frame_meta(meta);
+            }
+
+            // osd_frame is owned by the osd node's output and not drawn on again, share it. meta->frame may still be
+            // written by other nodes (osd wrappers, brokers) while the I/O thread encodes, so take a copy of it
+            // (resize makes a new one anyway)
+            auto use_osd = !meta->osd_frame.empty() && osd;
+            cv::Mat image = use_osd ? meta->osd_frame : meta->frame;
+            if (resolution_w_h.width != 0 && resolution_w_h.height != 0 &&
+                (image.cols != resolution_w_h.width || image.rows != resolution_w_h.height)) {
+                cv::Mat resized;
+                cv::resize(image, resized, cv::Size(resolution_w_h.width, resolution_w_h.height));
+                image = resized;
+            }
+            else if (!use_osd) {
+                image = image.clone();
+            }
+
+            auto path = cvedix_utils::string_format(location, file_index);
+            cvedix_record_info info;
+            info.channel_index = meta->channel_index;
+            info.file_name_without_ext = path.substr(0, path.find_last_of('.'));
+            info.full_record_path = path;
+            info.record_type = cvedix_record_type::IMAGE;
+
+            auto quality = jpeg_quality;
+            auto hooker = image_record_complete_hooker;
+            auto accepted = writer->submit(path,
+                [image, quality]() {
+                    std::vector<uint8_t> buffer;
+                    cv::imencode(".jpg", image, buffer, {cv::IMWRITE_JPEG_QUALITY, quality});
+                    return buffer;
+                },
+                image.total() * image.elemSize(),
+                [info, hooker](const std::string&, bool ok) {
+                    if (ok && hooker) {
+                        hooker(info.channel_index, info);
+                    }
+                });
+            if (accepted) {
+                file_index++;
+                last_saved = now;
+            }
+            else {
+                CVEDIX_WARN(cvedix_utils::string_format("[%s] I/O queue full, image dropped", node_name.c_str()));
+            }
+            return cvedix_des_node::handle_frame_meta(meta);
+        }
+
+    public:
+        // interval: seconds (stream time) between 2 saved images. writer: shared I/O thread, a private one if null
+        cvedix_async_image_des_node(std::string node_name,
+                                    int channel_index,
+                                    std::string location,
+                                    double interval = 1,
+                                    cvedix_objects::cvedix_size resolution_w_h = {},
+                                    bool osd = true,
+                                    int jpeg_quality = 90,
+                                    std::shared_ptr<cvedix_utils::cvedix_async_file_writer> writer = nullptr):
+                                    cvedix_des_node(node_name, channel_index),
+                                    location(location),
+                                    interval(interval),
+                                    resolution_w_h(resolution_w_h),
+                                    osd(osd),
+                                    jpeg_quality(jpeg_quality),
+                                    writer(writer ? writer : std::make_shared<cvedix_utils::cvedix_async_file_writer>()) {
+            this->initialized();
+        }
+        ~cvedix_async_image_des_node() = default;
+
+        // set before pipeline starts, called on the I/O thread
+        void set_image_record_complete_hooker(cvedix_image_record_complete_hooker hooker) {
+            image_record_complete_hooker = hooker;
+        }
+
+        std::shared_ptr<cvedix_utils::cvedix_async_file_writer> get_writer() {
+            return writer;
+        }
+    };
+}
@@ -0,0 +1,386 @@
+#pragma once
+
+#include "cvedix/nodes/des/cvedix_des_node.h"
+#include "cvedix/utils/cvedix_utils.h"
+#include "cvedix/utils/logger/cvedix_logger.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace cvedix_nodes {
+    enum class cvedix_multi_des_sink_type {
+        RTMP,       // push to rtmp server (flv)
+        RTSP,       // push to rtsp server (mediamtx, ...) by rtspclientsink
+        UDP,        // rtp/h264 over udp, e.g. for a local rtsp server reading from udp
+        MP4         // segmented mp4 files on disk
+    };
+
+    // one output of cvedix_multi_des_node
+    struct cvedix_multi_des_sink {
+        cvedix_multi_des_sink_type type;
+        std::string location;       // url for RTMP/RTSP, host for UDP, file pattern for MP4 ("./record/seg_%05d.mp4")
+        int port = 0;               // UDP only
+        int segment_seconds = 60;   // MP4 only, a new file at the first keyframe after this duration
+
+        static cvedix_multi_des_sink rtmp(const std::string& url) {
+            return {cvedix_multi_des_sink_type::RTMP, url};
+        }
+        static cvedix_multi_des_sink rtsp(const std::string& url) {
+            return {cvedix_multi_des_sink_type::RTSP, url};
+        }
+        static cvedix_multi_des_sink udp(const std::string& host, int port) {
+            return {cvedix_multi_des_sink_type::UDP, host, port};
+        }
+        static cvedix_multi_des_sink mp4(const std::string& pattern, int segment_seconds = 60) {
+            return {cvedix_multi_des_sink_type::MP4, pattern, 0, segment_seconds};
+        }
+    };
+
+    // encode once, output to many places.
+    // a split node feeding cvedix_rtmp_des_node + cvedix_rtsp_des_node + cvedix_file_des_node runs one H.264 encoder
+    // per destination on the same frames. this node runs a single encoder pipeline and hands its packets to one small
+    // gstreamer pipeline per sink (buffers are shared, not copied):
+    //
+    // appsrc ! videoconvert ! encoder ! h264parse ! appsink ─┬─ appsrc ! h264parse ! flvmux ! rtmpsink
+    //                                                         ├─ appsrc ! h264parse ! rtspclientsink
+    //                                                         ├─ appsrc ! h264parse ! rtph264pay ! udpsink
+    //                                                         └─ appsrc ! h264parse ! splitmuxsink (mp4 segments)
+    //
+    // sinks fail alone: errors on the bus of a sink pipeline (server gone, disk full) close that pipeline only, it is
+    // opened again after a backoff (2s doubling up to 60s) and starts at the next keyframe. the mp4 recording keeps
+    // going while a network output is down.
+    // nothing is dropped inside an encoded GOP: a raw frame is dropped before the encoder if the encoder falls
+    // behind, and a sink which can not keep up (queued data over 2s of bitrate for network sinks, 30s for files)
+    // drops packets up to its next keyframe, so every sink only gets decodable GOPs.
+    // `encoder` replaces x264enc for hardware encoders (e.g. "mpph264enc" on rockchip, "nvv4l2h264enc" on jetson),
+    // %d in it is replaced by bitrate (kbps). key frame interval matters for mp4 segment length, join latency of
+    // network clients and how long a sink drops after overload or reconnect.
+    class cvedix_multi_des_node: public cvedix_des_node {
+    private:
+        struct stage {
+            std::string name;               // for logs
+            GstElement* pipeline = nullptr;
+            GstElement* src = nullptr;
+            GstElement* sink = nullptr;     // encoder only
+            GstBus* bus = nullptr;
+            std::chrono::steady_clock::time_point retry_at;
+            std::chrono::steady_clock::time_point opened_at;
+            int failures = 0;
+        };
+
+        struct sink_stage: stage {
+            std::string description;
+            size_t max_queued_bytes = 0;
+            bool waiting_keyframe = true;   // after open or a drop, nothing is pushed before a keyframe
+            GstClockTime first_pts = GST_CLOCK_TIME_NONE;
+            uint64_t dropped = 0;
+        };
+
+        std::vector<cvedix_multi_des_sink> sinks;
+        cvedix_objects::cvedix_size resolution_w_h;
+        int bitrate;
+        bool osd;
+        int key_int;
+        std::string encoder;
+        stage encoder_stage;
+        std::string encoder_description;
+        int width = 0;
+        int height = 0;
+        GstClockTime frame_duration = 0;
+        std::vector<sink_stage> outputs;
+
+        std::string make_output_description(const cvedix_multi_des_sink& s) const {
+            std::stringstream ss;
+            ss << "appsrc name=src is-live=true format=time caps=video/x-h264,stream-format=byte-stream,alignment=au ! h264parse ! ";
+            switch (s.type) {
+            case cvedix_multi_des_sink_type::RTMP:
+                ss << "flvmux streamable=true ! rtmpsink location=\"" << s.location << " live=1\" sync=false";
+                break;
+            case cvedix_multi_des_sink_type::RTSP:
+                ss << "rtspclientsink location=" << s.location << " protocols=tcp";
+                break;
+            case cvedix_multi_des_sink_type::UDP:
+                ss << "rtph264pay config-interval=1 pt=96 ! udpsink host=" << s.location << " port=" << s.port << " sync=false async=false";
+                break;
+            case cvedix_multi_des_sink_type::MP4:
+                ss << "splitmuxsink location=" << s.location
+                   << " max-size-time=" << static_cast<long long>(s.segment_seconds) * 1000000000LL << " muxer-factory=mp4mux";
+                break;
+            }
+            return ss.str();
+        }
+
+        bool launch(stage& s, const std::string& description) {
+            GError* error = nullptr;
+            s.pipeline = gst_parse_launch(description.c_str(), &error);
+            if (!s.pipeline || error) {
+                CVEDIX_ERROR(cvedix_utils::string_format("[%s] create pipeline failed: %s", node_name.c_str(), error ? error->message : description.c_str()));
+                if (error) g_error_free(error);
+                if (s.pipeline) gst_object_unref(s.pipeline);
+                s.pipeline = nullptr;
+                retry_later(s);
+                return false;
+            }
+            s.src = gst_bin_get_by_name(GST_BIN(s.pipeline), "src");
+            s.sink = gst_bin_get_by_name(GST_BIN(s.pipeline), "sink");
+            s.bus = gst_element_get_bus(s.pipeline);
+            s.opened_at = std::chrono::steady_clock::now();
+            if (gst_element_set_state(s.pipeline, GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE) {
+                fail(s, "set pipeline to playing failed: " + description);
+                return false;
+            }
+            return true;
+        }
+
+        // `eos`: let muxers finish (mp4 index) before tearing down, waits at most `timeout`
+        static void close(stage& s, bool eos, GstClockTime timeout = 3 * GST_SECOND) {
+            if (!s.pipeline) {
+                return;
+            }
+            if (eos && s.src) {
+                gst_app_src_end_of_stream(GST_APP_SRC(s.src));
+                if (auto message = gst_bus_timed_pop_filtered(s.bus, timeout, static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR))) {
+                    gst_message_unref(message);
+                }
+            }
+            gst_element_set_state(s.pipeline, GST_STATE_NULL);
+            if (s.src) gst_object_unref(s.src);
+            if (s.sink) gst_object_unref(s.sink);
+            gst_object_unref(s.bus);
+            gst_object_unref(s.pipeline);
+            s.pipeline = s.src = s.sink = nullptr;
+            s.bus = nullptr;
+        }
+
+        // close after an error and open again later, backoff grows while failures follow each other quickly
+        void fail(stage& s, const std::string& reason) {
+            CVEDIX_ERROR(cvedix_utils::string_format("[%s] %s", node_name.c_str(), reason.c_str()));
+            close(s, false);
+            retry_later(s);
+        }
+
+        static void retry_later(stage& s) {
+            auto now = std::chrono::steady_clock::now();
+            if (now - s.opened_at > std::chrono::seconds(30)) {
+                s.failures = 0;
+            }
+            s.failures++;
+            s.retry_at = now + std::chrono::seconds(std::min(60, 1 << std::min(s.failures, 6)));
+        }
+
+        // errors of a running pipeline only show up on its bus, gst_app_src_push_buffer(...) keeps succeeding
+        bool healthy(stage& s) {
+            if (!s.pipeline) {
+                return false;
+            }
+            auto message = gst_bus_pop_filtered(s.bus, static_cast<GstMessageType>(GST_MESSAGE_ERROR | GST_MESSAGE_EOS));
+            if (!message) {
+                return true;
+            }
+            std::string reason = s.name + " stopped (eos)";
+            if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR) {
+                GError* error = nullptr;
+                gchar* debug = nullptr;
+                gst_message_parse_error(message, &error, &debug);
+                reason = s.name + " failed: " + (error ? error->message : "unknown error");
+                if (error) g_error_free(error);
+                if (debug) g_free(debug);
+            }
+            gst_message_unref(message);
+            fail(s, reason);
+            return false;
+        }
+
+        bool open_encoder(int w, int h, int fps) {
+            encoder_description = cvedix_utils::string_format(
+                "appsrc name=src is-live=true format=time caps=video/x-raw,format=BGR,width=%d,height=%d,framerate=%d/1 ! "
+                "videoconvert ! video/x-raw,format=I420 ! %s ! "
+                "h264parse config-interval=-1 ! video/x-h264,stream-format=byte-stream,alignment=au ! appsink name=sink sync=false",
+                w, h, fps, cvedix_utils::string_format(encoder, bitrate).c_str());
+            if (!launch(encoder_stage, encoder_description)) {
+                return false;
+            }
+            width = w;
+            height = h;
+            frame_duration = GST_SECOND / fps;
+            CVEDIX_INFO(cvedix_utils::string_format("[%s] encode once for %d outputs: %s", node_name.c_str(), static_cast<int>(outputs.size()), encoder_description.c_str()));
+            return true;
+        }
+
+        void write_packet(sink_stage& o, GstBuffer* buffer, std::chrono::steady_clock::time_point now) {
+            auto keyframe = !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+            if (!o.pipeline) {
+                // (re)open at a keyframe only, the sink starts with a decodable GOP
+                if (!keyframe || now < o.retry_at || !launch(o, o.description)) {
+                    return;
+                }
+                o.waiting_keyframe = true;
+                o.first_pts = GST_CLOCK_TIME_NONE;
+            }
+            else if (!healthy(o)) {
+                return;
+            }
+
+            if (!keyframe && o.waiting_keyframe) {
+                o.dropped++;
+                return;
+            }
+            if (gst_app_src_get_current_level_bytes(GST_APP_SRC(o.src)) > o.max_queued_bytes) {
+                // sink can not keep up, skip the rest of this GOP (and this keyframe's)
+                if (!o.waiting_keyframe) {
+                    CVEDIX_WARN(cvedix_utils::string_format("[%s] %s is behind, dropping up to next keyframe (%llu packets dropped so far)",
+                                                            node_name.c_str(), o.name.c_str(), static_cast<unsigned long long>(o.dropped)));
+                }
+                o.waiting_keyframe = true;
+                o.dropped++;
+                return;
+            }
+            o.waiting_keyframe = false;
+
+            // timestamps of every sink start at 0 when it is opened
+            auto pts = GST_BUFFER_PTS(buffer);
+            if (o.first_pts == GST_CLOCK_TIME_NONE) {
+                o.first_pts = GST_CLOCK_TIME_IS_VALID(pts) ? pts : 0;
+            }
+            auto copy = gst_buffer_copy(buffer);    // shares memory, own timestamps
+            auto dts = GST_BUFFER_DTS(copy);
+            GST_BUFFER_PTS(copy) = GST_CLOCK_TIME_IS_VALID(pts) && pts >= o.first_pts ? pts - o.first_pts : GST_CLOCK_TIME_NONE;
+            GST_BUFFER_DTS(copy) = GST_CLOCK_TIME_IS_VALID(dts) && dts >= o.first_pts ? dts - o.first_pts : GST_CLOCK_TIME_NONE;
+            gst_app_src_push_buffer(GST_APP_SRC(o.src), copy);
+        }
+
+        // encoded packets ready so far go to every sink
+        void dispatch_packets(GstClockTime timeout = 0) {
+            auto now = std::chrono::steady_clock::now();
+            while (auto sample = gst_app_sink_try_pull_sample(GST_APP_SINK(encoder_stage.sink), timeout)) {
+                if (auto buffer = gst_sample_get_buffer(sample)) {
+                    for (auto& o: outputs) {
+                        write_packet(o, buffer, now);
+                    }
+                }
+                gst_sample_unref(sample);
+            }
+        }
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            auto& source = (meta->osd_frame.empty() || !osd) ? meta->frame : meta->osd_frame;
+            cv::Mat output;
+            if (resolution_w_h.width != 0 && resolution_w_h.height != 0 &&
+                (source.cols != resolution_w_h.width || source.rows != resolution_w_h.height)) {
+                cv::resize(source, output, cv::Size(resolution_w_h.width, resolution_w_h.height));
+            }
+            else {
+                output = source;
+            }
+
+            if (encoder_stage.pipeline && (output.cols != width || output.rows != height)) {
+                // resolution changed, sinks start new streams with the new encoder
+                close(encoder_stage, false);
+                for (auto& o: outputs) {
+                    close(o, true);
+                }
+            }
+            if (!encoder_stage.pipeline || !healthy(encoder_stage)) {
+                if (std::chrono::steady_clock::now() < encoder_stage.retry_at ||
+                    !open_encoder(output.cols, output.rows, meta->fps > 0 ? meta->fps : 25)) {
+                    return cvedix_des_node::handle_frame_meta(meta);
+                }
+            }
+
+            // encoder behind (slow hardware, cpu starved): drop raw frames here, never encoded packets
+            auto frame_bytes = output.total() * output.elemSize();
+            if (gst_app_src_get_current_level_bytes(GST_APP_SRC(encoder_stage.src)) < frame_bytes * 4) {
+                auto buffer = gst_buffer_new_allocate(nullptr, frame_bytes, nullptr);
+                if (output.isContinuous()) {
+                    gst_buffer_fill(buffer, 0, output.data, frame_bytes);
+                }
+                else {
+                    auto continuous = output.clone();
+                    gst_buffer_fill(buffer, 0, continuous.data, frame_bytes);
+                }
+                GST_BUFFER_PTS(buffer) = static_cast<GstClockTime>(meta->frame_index) * frame_duration;
+                GST_BUFFER_DURATION(buffer) = frame_duration;
+                gst_app_src_push_buffer(GST_APP_SRC(encoder_stage.src), buffer);
+            }
+            dispatch_packets();
+            return cvedix_des_node::handle_frame_meta(meta);
+        }
+
+    public:
+        cvedix_multi_des_node(std::string node_name,
+                              int channel_index,
+                              std::vector<cvedix_multi_des_sink> sinks,
+                              cvedix_objects::cvedix_size resolution_w_h = {},
+                              int bitrate = 1024,
+                              bool osd = true,
+                              int key_int = 50,
+                              std::string encoder = ""):
+                              cvedix_des_node(node_name, channel_index),
+                              sinks(sinks),
+                              resolution_w_h(resolution_w_h),
+                              bitrate(bitrate),
+                              osd(osd),
+                              key_int(key_int),
+                              encoder(encoder) {
+            if (this->encoder.empty()) {
+                this->encoder = "x264enc bitrate=%d tune=zerolatency speed-preset=ultrafast key-int-max=" + std::to_string(key_int);
+            }
+            for (auto& s: this->sinks) {
+                sink_stage o;
+                o.name = "sink " + s.location;
+                o.description = make_output_description(s);
+                auto seconds = s.type == cvedix_multi_des_sink_type::MP4 ? 30 : 2;
+                o.max_queued_bytes = std::max<size_t>(256 * 1024, static_cast<size_t>(bitrate) * 125 * seconds);
+                outputs.push_back(o);
+            }
+            encoder_stage.name = "encoder";
+            if (!gst_is_initialized()) {
+                gst_init(nullptr, nullptr);
+            }
+            this->initialized();
+        }
+        ~cvedix_multi_des_node() {
+            // drain the encoder, then finish every sink (mp4 segment in progress is finalized)
+            if (encoder_stage.pipeline) {
+                gst_app_src_end_of_stream(GST_APP_SRC(encoder_stage.src));
+                auto until = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+                while (!gst_app_sink_is_eos(GST_APP_SINK(encoder_stage.sink)) && std::chrono::steady_clock::now() < until) {
+                    dispatch_packets(100 * GST_MSECOND);
+                }
+            }
+            for (auto& o: outputs) {
+                close(o, true);
+            }
+            close(encoder_stage, false);
+        }
+
+        // output size, empty if frames are encoded at their own size
+        cvedix_objects::cvedix_size get_resolution() const {
+            return resolution_w_h;
+        }
+
+        // true if osd_frame is encoded (when there is one)
+        bool get_osd() const {
+            return osd;
+        }
+
+        // gstreamer pipeline strings used by this node, encoder (once running) first, then one per sink
+        std::string get_pipeline() const {
+            std::string pipelines = encoder_description;
+            for (auto& o: outputs) {
+                pipelines += (pipelines.empty() ? "" : "\n") + o.description;
+            }
+            return pipelines;
+        }
+    };
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "cvedix_ext/utils/cvedix_blocking_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cvedix_nodes {
+    // time cost of each stage (average in ms) since node started
+    struct cvedix_pipelined_stage_costs {
+        int jobs = 0;
+        double preprocess_ms = 0;
+        double infer_ms = 0;
+        double postprocess_ms = 0;
+    };
+
+    // wrap any infer node (cvedix_yolo_detector_node, cvedix_tiled_yolo_detector_node, ...) so that
+    // prepare+preprocess -> infer -> postprocess run on 3 dedicated threads instead of serially on node's thread.
+    // up to `inflight_depth` frames are in the pipeline at the same time and frames leave the node in arriving order
+    // (every stage is a single FIFO thread), so throughput approaches 1/max(stage) instead of 1/sum(stages).
+    // control metas are queued through the same stages, they never overtake frames still being inferred.
+    //
+    // usage:
+    // auto detector = std::make_shared<cvedix_pipelined_infer_node<cvedix_yolo_detector_node>>(3, "detector", weights, cfg, labels);
+    //
+    // NOTE:
+    // 1. batch_size of wrapped node MUST be 1 (batched metas are pushed by node's own loop synchronously).
+    // 2. prepare/preprocess/postprocess of wrapped node run concurrently for different frames, they must not share
+    //    per-frame state through members (net is only touched by the infer stage).
+    template<typename infer_node_t>
+    class cvedix_pipelined_infer_node: public infer_node_t {
+    private:
+        struct infer_job {
+            std::shared_ptr<cvedix_objects::cvedix_control_meta> control_meta;  // not null means pass through only
+            std::vector<std::shared_ptr<cvedix_objects::cvedix_frame_meta>> frame_meta_with_batch;
+            std::vector<cv::Mat> mats_to_infer;
+            cv::Mat blob_to_infer;
+            std::vector<cv::Mat> raw_outputs;
+        };
+        using infer_job_ptr = std::shared_ptr<infer_job>;
+
+        int inflight_depth;
+        int inflight = 0;
+        bool closed = false;
+        std::mutex inflight_lock;
+        std::condition_variable inflight_cond;
+
+        cvedix_utils::cvedix_blocking_queue<infer_job_ptr> preprocess_queue;
+        cvedix_utils::cvedix_blocking_queue<infer_job_ptr> infer_queue;
+        cvedix_utils::cvedix_blocking_queue<infer_job_ptr> postprocess_queue;
+
+        std::thread preprocess_th;
+        std::thread infer_th;
+        std::thread postprocess_th;
+
+        std::atomic<int> jobs {0};
+        std::atomic<int64_t> preprocess_ns {0};
+        std::atomic<int64_t> infer_ns {0};
+        std::atomic<int64_t> postprocess_ns {0};
+
+        static int64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        // called on node's thread, blocks when `inflight_depth` jobs are already in the pipeline (backpressure).
+        // false if the stages are closed (node destructing), the job is dropped then
+        bool submit(infer_job_ptr job) {
+            {
+                std::unique_lock<std::mutex> guard(inflight_lock);
+                inflight_cond.wait(guard, [this] { return closed || inflight < inflight_depth; });
+                if (closed) {
+                    return false;
+                }
+                inflight++;
+            }
+            if (!preprocess_queue.push(job)) {
+                std::lock_guard<std::mutex> guard(inflight_lock);
+                inflight--;
+                inflight_cond.notify_all();
+                return false;
+            }
+            return true;
+        }
+
+        void preprocess_run() {
+            infer_job_ptr job;
+            while (preprocess_queue.pop(job)) {
+                if (!job->control_meta) {
+                    auto start = std::chrono::steady_clock::now();
+                    this->prepare(job->frame_meta_with_batch, job->mats_to_infer);
+                    if (!job->mats_to_infer.empty()) {
+                        this->preprocess(job->mats_to_infer, job->blob_to_infer);
+                    }
+                    preprocess_ns += elapsed_ns(start);
+                }
+                infer_queue.push(job);
+            }
+            infer_queue.close();
+        }
+
+        void infer_run() {
+            infer_job_ptr job;
+            while (infer_queue.pop(job)) {
+                if (!job->control_meta && !job->mats_to_infer.empty()) {
+                    auto start = std::chrono::steady_clock::now();
+                    this->infer(job->blob_to_infer, job->raw_outputs);
+                    infer_ns += elapsed_ns(start);
+                }
+                postprocess_queue.push(job);
+            }
+            postprocess_queue.close();
+        }
+
+        void postprocess_run() {
+            infer_job_ptr job;
+            while (postprocess_queue.pop(job)) {
+                if (job->control_meta) {
+                    auto meta = infer_node_t::handle_control_meta(job->control_meta);
+                    if (meta != nullptr) {
+                        this->pendding_meta(meta);
+                    }
+                }
+                else {
+                    if (!job->mats_to_infer.empty()) {
+                        auto start = std::chrono::steady_clock::now();
+                        this->postprocess(job->raw_outputs, job->frame_meta_with_batch);
+                        postprocess_ns += elapsed_ns(start);
+                    }
+                    jobs++;
+                    for (auto& meta: job->frame_meta_with_batch) {
+                        this->pendding_meta(meta);
+                    }
+                }
+
+                std::lock_guard<std::mutex> guard(inflight_lock);
+                inflight--;
+                inflight_cond.notify_one();
+            }
+        }
+
+    protected:
+        // meta is pushed later by postprocess stage, return nullptr so node's loop does not push it twice
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            auto job = std::make_shared<infer_job>();
+            job->frame_meta_with_batch.push_back(meta);
+            submit(job);
+            return nullptr;
+        }
+
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_control_meta(std::shared_ptr<cvedix_objects::cvedix_control_meta> meta) override {
+            auto job = std::make_shared<infer_job>();
+            job->control_meta = meta;
+            submit(job);
+            return nullptr;
+        }
+
+    public:
+        template<typename... args_t>
+        cvedix_pipelined_infer_node(int inflight_depth, args_t&&... args):
+                                    infer_node_t(std::forward<args_t>(args)...),
+                                    inflight_depth(std::max(1, inflight_depth)) {
+            preprocess_th = std::thread(&cvedix_pipelined_infer_node::preprocess_run, this);
+            infer_th = std::thread(&cvedix_pipelined_infer_node::infer_run, this);
+            postprocess_th = std::thread(&cvedix_pipelined_infer_node::postprocess_run, this);
+        }
+
+        ~cvedix_pipelined_infer_node() {
+            // stop node's thread first so nothing is submitted any more, then release a submit still waiting for room
+            this->deinitialized();
+            {
+                std::lock_guard<std::mutex> guard(inflight_lock);
+                closed = true;
+            }
+            inflight_cond.notify_all();
+            // stages close the next queue when drained, so closing the first one stops all of them in order
+            preprocess_queue.close();
+            if (preprocess_th.joinable()) {
+                preprocess_th.join();
+            }
+            if (infer_th.joinable()) {
+                infer_th.join();
+            }
+            if (postprocess_th.joinable()) {
+                postprocess_th.join();
+            }
+        }
+
+        cvedix_pipelined_stage_costs get_stage_costs() {
+            cvedix_pipelined_stage_costs costs;
+            costs.jobs = jobs;
+            if (costs.jobs > 0) {
+                costs.preprocess_ms = preprocess_ns / 1e6 / costs.jobs;
+                costs.infer_ms = infer_ns / 1e6 / costs.jobs;
+                costs.postprocess_ms = postprocess_ns / 1e6 / costs.jobs;
+            }
+            return costs;
+        }
+    };
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "cvedix_ext/utils/cvedix_model_registry.h"
+
+#include <utility>
+
+namespace cvedix_nodes {
+    // wrap any opencv-dnn based infer node (cvedix_yunet_face_detector_node, cvedix_sface_feature_encoder_node,
+    // cvedix_yolo_detector_node, ...) so that all instances created with the same model key run on ONE network
+    // from cvedix_model_registry instead of each keeping its own copy of weights and runtime buffers.
+    //
+    // the first node of a key donates the network it loaded in its constructor to the registry, later nodes donate
+    // theirs as extra contexts while the model has less than max_contexts, otherwise drop their private copy right
+    // after construction. at infer time the node borrows an inference context from the shared model and runs its own
+    // infer(...) logic on it, so outputs are identical to the unwrapped node.
+    //
+    // usage:
+    // cvedix_utils::cvedix_model_key key{"./cvedix_data/models/face/face_detection_yunet_2022mar.onnx"};
+    // auto detector = std::make_shared<cvedix_shared_model_infer_node<cvedix_yunet_face_detector_node>>(key, 1, "detector_0", key.model_path);
+    //
+    // NOTE:
+    // startup time is NOT reduced: sdk infer nodes load their model eagerly in their own constructor, so every wrapped
+    // node still parses the model once. only resident memory (weights and runtime allocations per extra instance) is
+    // saved. max_contexts > 1 allows that many nodes to infer concurrently on the same model at the cost of one
+    // network copy per context.
+    template<typename infer_node_t>
+    class cvedix_shared_model_infer_node: public infer_node_t {
+    private:
+        std::shared_ptr<cvedix_utils::cvedix_shared_model> shared_model;
+
+    protected:
+        // borrow a context, swap it in as `net` for the duration of the wrapped node's own infer(...)
+        virtual void infer(const cv::Mat& blob_to_infer, std::vector<cv::Mat>& raw_outputs) override {
+            cvedix_utils::cvedix_shared_model::lease ctx(shared_model.get());
+            std::swap(this->net, ctx.net());
+            try {
+                infer_node_t::infer(blob_to_infer, raw_outputs);
+            }
+            catch (...) {
+                std::swap(this->net, ctx.net());
+                throw;
+            }
+            std::swap(this->net, ctx.net());
+        }
+
+    public:
+        template<typename... args_t>
+        cvedix_shared_model_infer_node(cvedix_utils::cvedix_model_key model_key, int max_contexts, args_t&&... args):
+                                       infer_node_t(std::forward<args_t>(args)...) {
+            auto loader = cvedix_utils::cvedix_model_registry::default_loader(model_key);
+            bool created = false;
+            shared_model = cvedix_utils::cvedix_model_registry::get().acquire(model_key, loader, max_contexts, this->net, &created);
+            // model existed already: keep the parsed copy as another context if there is room, instead of parsing
+            // again in a lazy load later
+            if (!created) {
+                shared_model->donate(this->net);
+            }
+            // private copy (or the reference donated to registry) is not used anymore
+            this->net = cv::dnn::Net();
+        }
+        ~cvedix_shared_model_infer_node() = default;
+
+        std::shared_ptr<cvedix_utils::cvedix_shared_model> get_shared_model() {
+            return shared_model;
+        }
+    };
+}
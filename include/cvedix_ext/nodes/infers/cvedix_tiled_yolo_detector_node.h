@@ -0,0 +1,214 @@
+#pragma once
+
+#include "cvedix/nodes/cvedix_primary_infer_node.h"
+
+#include <opencv2/dnn.hpp>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace cvedix_nodes {
+    // yolo detector (darknet cfg/weights, same model files as cvedix_yolo_detector_node) running in tiled mode.
+    // high-resolution frames are cut into overlapping tiles (optionally only inside configured regions),
+    // all tiles of one frame are sent to the network as ONE batch, and detections are merged back into
+    // frame coordinates with cross-tile NMS. small/far objects keep their pixels instead of vanishing
+    // after a full-frame downscale, which is much cheaper than raising input size of the network.
+    class cvedix_tiled_yolo_detector_node: public cvedix_primary_infer_node {
+    private:
+        int tile_width;
+        int tile_height;
+        float tile_overlap;
+        bool include_full_frame;
+        float score_threshold;
+        float confidence_threshold;
+        float nms_threshold;
+        // channel -> regions to tile, the whole frame is tiled if no region set for channel
+        std::map<int, std::vector<cvedix_objects::cvedix_rect>> tile_regions;
+
+        // tile layout (in frame coordinates) of every frame per batch, pushed in prepare(...) and popped in postprocess(...).
+        // FIFO instead of a single slot since prepare of next frame may run before postprocess of current one
+        // when the node is wrapped by cvedix_pipelined_infer_node.
+        std::deque<std::vector<std::vector<cv::Rect>>> pending_tiles;
+        std::mutex pending_tiles_lock;
+
+        // 1-D tile start positions covering [start, start + length) with overlap, last tile aligned to the end
+        static std::vector<int> tile_starts(int start, int length, int tile, float overlap) {
+            std::vector<int> starts;
+            if (length <= tile) {
+                starts.push_back(start);
+                return starts;
+            }
+            auto step = std::max(1, static_cast<int>(tile * (1.0f - overlap)));
+            for (int s = start; s + tile < start + length; s += step) {
+                starts.push_back(s);
+            }
+            starts.push_back(start + length - tile);
+            return starts;
+        }
+
+        std::vector<cv::Rect> make_tiles(const std::shared_ptr<cvedix_objects::cvedix_frame_meta>& meta) {
+            std::vector<cv::Rect> tiles;
+            auto frame_rect = cv::Rect(0, 0, meta->frame.cols, meta->frame.rows);
+            if (include_full_frame) {
+                tiles.push_back(frame_rect);
+            }
+
+            std::vector<cv::Rect> areas;
+            auto it = tile_regions.find(meta->channel_index);
+            if (it != tile_regions.end() && !it->second.empty()) {
+                for (auto& r: it->second) {
+                    auto area = cv::Rect(r.x, r.y, r.width, r.height) & frame_rect;
+                    if (area.area() > 0) {
+                        areas.push_back(area);
+                    }
+                }
+            }
+            else {
+                areas.push_back(frame_rect);
+            }
+
+            for (auto& area: areas) {
+                auto w = std::min(tile_width, area.width);
+                auto h = std::min(tile_height, area.height);
+                for (auto y: tile_starts(area.y, area.height, h, tile_overlap)) {
+                    for (auto x: tile_starts(area.x, area.width, w, tile_overlap)) {
+                        tiles.push_back(cv::Rect(x, y, w, h) & frame_rect);
+                    }
+                }
+            }
+            return tiles;
+        }
+
+    protected:
+        // cut tiles out of frames (no copy, ROI only), the order of mats matches tile layout
+        virtual void prepare(const std::vector<std::shared_ptr<cvedix_objects::cvedix_frame_meta>>& frame_meta_with_batch, std::vector<cv::Mat>& mats_to_infer) override {
+            std::vector<std::vector<cv::Rect>> batch_tiles;
+            for (auto& meta: frame_meta_with_batch) {
+                std::vector<cv::Rect> tiles;
+                if (!meta->frame.empty()) {
+                    tiles = make_tiles(meta);
+                }
+                for (auto& tile: tiles) {
+                    mats_to_infer.push_back(meta->frame(tile));
+                }
+                batch_tiles.push_back(std::move(tiles));
+            }
+
+            // postprocess(...) is only called when there is something to infer
+            if (!mats_to_infer.empty()) {
+                std::lock_guard<std::mutex> guard(pending_tiles_lock);
+                pending_tiles.push_back(std::move(batch_tiles));
+            }
+        }
+
+        // decode yolo outputs per tile, map to frame coordinates and run cross-tile nms per class
+        virtual void postprocess(const std::vector<cv::Mat>& raw_outputs, const std::vector<std::shared_ptr<cvedix_objects::cvedix_frame_meta>>& frame_meta_with_batch) override {
+            std::vector<std::vector<cv::Rect>> batch_tiles;
+            {
+                std::lock_guard<std::mutex> guard(pending_tiles_lock);
+                if (pending_tiles.empty()) {
+                    return;
+                }
+                batch_tiles = std::move(pending_tiles.front());
+                pending_tiles.pop_front();
+            }
+
+            int total_tiles = 0;
+            for (auto& tiles: batch_tiles) {
+                total_tiles += tiles.size();
+            }
+            if (total_tiles == 0) {
+                return;
+            }
+
+            int tile_index = 0;
+            for (size_t f = 0; f < frame_meta_with_batch.size(); f++) {
+                auto& frame_meta = frame_meta_with_batch[f];
+                std::map<int, std::vector<cv::Rect>> boxes_by_class;
+                std::map<int, std::vector<float>> scores_by_class;
+
+                for (auto& tile: batch_tiles[f]) {
+                    for (auto& output: raw_outputs) {
+                        // output is [batch, rows, cols] or [batch * rows, cols] for darknet region layers
+                        auto cols = output.dims == 3 ? output.size[2] : output.cols;
+                        auto rows = output.dims == 3 ? output.size[1] : output.rows / total_tiles;
+                        auto data = reinterpret_cast<const float*>(output.data) + static_cast<size_t>(tile_index) * rows * cols;
+
+                        for (int r = 0; r < rows; r++, data += cols) {
+                            if (data[4] < score_threshold) {
+                                continue;
+                            }
+                            auto best = std::max_element(data + 5, data + cols);
+                            auto confidence = *best;
+                            if (confidence < confidence_threshold) {
+                                continue;
+                            }
+                            auto width = static_cast<int>(data[2] * tile.width);
+                            auto height = static_cast<int>(data[3] * tile.height);
+                            auto left = tile.x + static_cast<int>(data[0] * tile.width) - width / 2;
+                            auto top = tile.y + static_cast<int>(data[1] * tile.height) - height / 2;
+                            auto class_id = static_cast<int>(best - (data + 5));
+                            boxes_by_class[class_id].push_back(cv::Rect(left, top, width, height));
+                            scores_by_class[class_id].push_back(confidence);
+                        }
+                    }
+                    tile_index++;
+                }
+
+                // cross-tile nms, duplicates from overlapped tiles (and the full-frame pass) are removed here
+                auto frame_rect = cv::Rect(0, 0, frame_meta->frame.cols, frame_meta->frame.rows);
+                for (auto& [class_id, boxes]: boxes_by_class) {
+                    auto& scores = scores_by_class[class_id];
+                    std::vector<int> keep;
+                    cv::dnn::NMSBoxes(boxes, scores, confidence_threshold, nms_threshold, keep);
+                    for (auto i: keep) {
+                        auto box = boxes[i] & frame_rect;
+                        if (box.area() <= 0) {
+                            continue;
+                        }
+                        auto label = static_cast<size_t>(class_id) < labels.size() ? labels[class_id] : "";
+                        auto target = std::make_shared<cvedix_objects::cvedix_frame_target>(box.x, box.y, box.width, box.height,
+                                                                                            class_id + class_id_offset, scores[i],
+                                                                                            frame_meta->frame_index, frame_meta->channel_index, label);
+                        frame_meta->targets.push_back(target);
+                    }
+                }
+            }
+        }
+
+    public:
+        cvedix_tiled_yolo_detector_node(std::string node_name,
+                                        std::string model_path,
+                                        std::string model_config_path,
+                                        std::string labels_path,
+                                        int input_width = 416,
+                                        int input_height = 416,
+                                        int tile_width = 832,
+                                        int tile_height = 832,
+                                        float tile_overlap = 0.2,
+                                        std::map<int, std::vector<cvedix_objects::cvedix_rect>> tile_regions = {},
+                                        bool include_full_frame = true,
+                                        int class_id_offset = 0,
+                                        float score_threshold = 0.5,
+                                        float confidence_threshold = 0.5,
+                                        float nms_threshold = 0.5,
+                                        float scale = 1 / 255.0,
+                                        cv::Scalar mean = cv::Scalar(0),
+                                        cv::Scalar std = cv::Scalar(1),
+                                        bool swap_rb = true):
+                                        cvedix_primary_infer_node(node_name, model_path, model_config_path, labels_path, input_width, input_height, 1, class_id_offset, scale, mean, std, swap_rb),
+                                        tile_width(tile_width),
+                                        tile_height(tile_height),
+                                        tile_overlap(std::min(std::max(tile_overlap, 0.0f), 0.9f)),
+                                        include_full_frame(include_full_frame),
+                                        score_threshold(score_threshold),
+                                        confidence_threshold(confidence_threshold),
+                                        nms_threshold(nms_threshold),
+                                        tile_regions(tile_regions) {
+            this->initialized();
+        }
+        ~cvedix_tiled_yolo_detector_node() = default;
+    };
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <utility>
+
+namespace cvedix_nodes {
+    // result of a warm-up pass, all values in ms
+    struct cvedix_warmup_result {
+        int runs = 0;
+        double first_ms = 0;        // cold run: backend allocation, kernel compile/tuning, lazy init in postprocess
+        double steady_ms = 0;       // average of the remaining runs, close to per-frame cost after start
+    };
+
+    // wrap any infer node to add an explicit warm-up pass before the pipeline starts.
+    // warm_up(...) runs the node's complete infer path (prepare -> preprocess -> infer -> postprocess) on dummy
+    // frames on the caller's thread and throws the results away, nothing is pushed to next nodes. call it after
+    // the node is created and before src nodes start, so the first real frames do not pay one-time allocations.
+    //
+    // by default a dummy frame is black with one full-frame target (class `0`), enough to drive primary detectors
+    // and secondary nodes applied on all classes. use set_warm_up_meta_builder(...) for anything else.
+    template<typename infer_node_t>
+    class cvedix_warmup_infer_node: public infer_node_t {
+    public:
+        typedef std::function<std::shared_ptr<cvedix_objects::cvedix_frame_meta>(cv::Size)> cvedix_warm_up_meta_builder;
+
+    private:
+        cvedix_warm_up_meta_builder meta_builder;
+
+        static std::shared_ptr<cvedix_objects::cvedix_frame_meta> default_meta(cv::Size frame_size) {
+            cv::Mat frame(frame_size, CV_8UC3, cv::Scalar::all(0));
+            auto meta = std::make_shared<cvedix_objects::cvedix_frame_meta>(frame, -1, -1, frame_size.width, frame_size.height);
+            meta->targets.push_back(std::make_shared<cvedix_objects::cvedix_frame_target>(0, 0, frame_size.width, frame_size.height, 0, 1.0, -1, -1, ""));
+            return meta;
+        }
+
+    public:
+        template<typename... args_t>
+        cvedix_warmup_infer_node(args_t&&... args):
+                                 infer_node_t(std::forward<args_t>(args)...),
+                                 meta_builder(default_meta) {}
+        ~cvedix_warmup_infer_node() = default;
+
+        void set_warm_up_meta_builder(cvedix_warm_up_meta_builder builder) {
+            meta_builder = builder;
+        }
+
+        // frame_size should be the (resized) resolution of src node feeding this node
+        cvedix_warmup_result warm_up(cv::Size frame_size = cv::Size(1280, 720), int runs = 3) {
+            cvedix_warmup_result result;
+            double steady_total = 0;
+            for (int i = 0; i < runs; i++) {
+                std::vector<std::shared_ptr<cvedix_objects::cvedix_frame_meta>> frame_meta_with_batch {meta_builder(frame_size)};
+                auto start = std::chrono::steady_clock::now();
+                this->run_infer_combinations(frame_meta_with_batch);
+                auto cost = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                if (i == 0) {
+                    result.first_ms = cost;
+                }
+                else {
+                    steady_total += cost;
+                }
+                result.runs++;
+            }
+            if (result.runs > 1) {
+                result.steady_ms = steady_total / (result.runs - 1);
+            }
+            return result;
+        }
+    };
+}
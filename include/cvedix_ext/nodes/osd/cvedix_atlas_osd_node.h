@@ -0,0 +1,76 @@
+#pragma once
+
+#include "cvedix/nodes/cvedix_node.h"
+#include "cvedix_ext/utils/cvedix_text_atlas.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <memory>
+#include <string>
+
+namespace cvedix_nodes {
+    // osd for targets (rect, label, track id) drawing text through a shared cvedix_utils::cvedix_text_atlas instead
+    // of calling cv::freetype for every label of every frame. meant for pipelines where label rendering dominates osd
+    // time: CJK class names, plate strings (plate detectors put plate text into primary_label), long labels.
+    // nodes created with the same font file share one atlas, glyphs are rasterized once per process.
+    //
+    // usage:
+    // auto osd = std::make_shared<cvedix_atlas_osd_node>("osd_0", "./cvedix_data/font/NotoSansCJKsc-Medium.otf");
+    class cvedix_atlas_osd_node: public cvedix_node {
+    private:
+        std::shared_ptr<cvedix_utils::cvedix_text_atlas> atlas;
+        int font_height;
+        bool draw_score;
+
+        static cv::Scalar color_of(int class_id) {
+            static const cv::Scalar palette[] = {{0, 255, 0}, {255, 128, 0}, {0, 128, 255}, {255, 0, 255},
+                                                 {0, 255, 255}, {255, 255, 0}, {128, 0, 255}, {0, 0, 255}};
+            return palette[(class_id < 0 ? 0 : class_id) % 8];
+        }
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            if (meta->osd_frame.empty()) {
+                meta->osd_frame = meta->frame.clone();
+            }
+            auto& canvas = meta->osd_frame;
+
+            for (auto& t: meta->targets) {
+                auto color = color_of(t->primary_class_id);
+                cv::rectangle(canvas, cv::Rect(t->x, t->y, t->width, t->height), color, 2);
+
+                auto label = t->primary_label;
+                if (draw_score) {
+                    label += " " + std::to_string(static_cast<int>(t->primary_score * 100)) + "%";
+                }
+                if (t->track_id >= 0) {
+                    label += " #" + std::to_string(t->track_id);
+                }
+                auto text = atlas->render(label, font_height);
+                // label above rect on a filled background, inside the rect if no room above
+                auto y = t->y - text->alpha.rows - 4 >= 0 ? t->y - text->alpha.rows - 4 : t->y;
+                cv::rectangle(canvas, cv::Rect(t->x, y, text->alpha.cols + 4, text->alpha.rows + 4), color, cv::FILLED);
+                cvedix_utils::cvedix_text_atlas::blend(canvas, *text, cv::Point(t->x + 2, y + 2), cv::Scalar(0, 0, 0));
+            }
+            return meta;
+        }
+
+    public:
+        cvedix_atlas_osd_node(std::string node_name,
+                              std::string font_path,
+                              int font_height = 20,
+                              bool draw_score = false):
+                              cvedix_node(node_name),
+                              atlas(cvedix_utils::cvedix_text_atlas::acquire(font_path)),
+                              font_height(font_height),
+                              draw_score(draw_score) {
+            this->initialized();
+        }
+        ~cvedix_atlas_osd_node() = default;
+
+        // shared atlas, other custom osd nodes can draw text with it too
+        std::shared_ptr<cvedix_utils::cvedix_text_atlas> get_text_atlas() {
+            return atlas;
+        }
+    };
+}
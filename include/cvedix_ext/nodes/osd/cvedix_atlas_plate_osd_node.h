@@ -0,0 +1,71 @@
+#pragma once
+
+#include "cvedix/nodes/osd/cvedix_plate_osd_node.h"
+#include "cvedix_ext/utils/cvedix_text_atlas.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cvedix_nodes {
+    // cvedix_plate_osd_node with plate strings drawn through a shared cvedix_utils::cvedix_text_atlas. the sdk node
+    // still draws everything else of its plate layout (plate rects and colors), it only gets targets with empty
+    // labels, so it never calls cv::freetype. the plate text (primary_label, set by the plate detectors) is then
+    // blended from cached glyphs above the plate rect, white on black.
+    // nodes created with the same font file share one atlas with cvedix_atlas_osd_node.
+    //
+    // usage:
+    // auto osd = std::make_shared<cvedix_atlas_plate_osd_node>("osd_0", "./cvedix_data/font/NotoSansCJKsc-Medium.otf");
+    class cvedix_atlas_plate_osd_node: public cvedix_plate_osd_node {
+    private:
+        std::shared_ptr<cvedix_utils::cvedix_text_atlas> atlas;
+        int font_height;
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            // labels are hidden from the sdk osd only while it draws, downstream nodes see them unchanged
+            std::vector<std::string> labels;
+            labels.reserve(meta->targets.size());
+            for (auto& t: meta->targets) {
+                labels.push_back(std::move(t->primary_label));
+                t->primary_label.clear();
+            }
+            cvedix_plate_osd_node::handle_frame_meta(meta);
+            for (size_t i = 0; i < labels.size(); i++) {
+                meta->targets[i]->primary_label = std::move(labels[i]);
+            }
+
+            if (meta->osd_frame.empty()) {
+                meta->osd_frame = meta->frame.clone();
+            }
+            auto& canvas = meta->osd_frame;
+            for (auto& t: meta->targets) {
+                if (t->primary_label.empty()) {
+                    continue;
+                }
+                auto text = atlas->render(t->primary_label, font_height);
+                // above the plate, below it if no room above
+                auto y = t->y - text->alpha.rows - 4 >= 0 ? t->y - text->alpha.rows - 4 : t->y + t->height;
+                cv::rectangle(canvas, cv::Rect(t->x, y, text->alpha.cols + 4, text->alpha.rows + 4), cv::Scalar(0, 0, 0), cv::FILLED);
+                cvedix_utils::cvedix_text_atlas::blend(canvas, *text, cv::Point(t->x + 2, y + 2), cv::Scalar(255, 255, 255));
+            }
+            return meta;
+        }
+
+    public:
+        // initialized() is called by cvedix_plate_osd_node
+        cvedix_atlas_plate_osd_node(std::string node_name,
+                                    std::string font_path,
+                                    int font_height = 24):
+                                    cvedix_plate_osd_node(node_name, font_path),
+                                    atlas(cvedix_utils::cvedix_text_atlas::acquire(font_path)),
+                                    font_height(font_height) {}
+        ~cvedix_atlas_plate_osd_node() = default;
+
+        std::shared_ptr<cvedix_utils::cvedix_text_atlas> get_text_atlas() {
+            return atlas;
+        }
+    };
+}
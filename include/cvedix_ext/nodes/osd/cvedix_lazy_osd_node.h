@@ -0,0 +1,62 @@
+#pragma once
+
+#include "cvedix_ext/nodes/osd/cvedix_osd_consumers.h"
+
+#include <atomic>
+#include <utility>
+
+namespace cvedix_nodes {
+    // wrap any osd node (cvedix_osd_node, cvedix_face_osd_node, cvedix_ba_crossline_osd_node, ...) to skip
+    // rendering (full-frame copy + drawing) when no node downstream reads osd_frame, meta passes through untouched then.
+    // consumers are found by cvedix_osd_consumer_cache: by default des nodes with osd on (not cvedix_fake_des_node) and
+    // record nodes, set_osd_consumer_checker(...) to change that (custom des nodes, brokers encoding osd_frame, ...).
+    // the graph is walked once on the first frame, call refresh_consumers() after attaching/detaching nodes while
+    // running.
+    // to also render at the smallest resolution serving every consumer, wrap cvedix_scaled_osd_node, it uses the
+    // same consumer set: cvedix_lazy_osd_node<cvedix_scaled_osd_node<cvedix_face_osd_node>>.
+    //
+    // usage:
+    // auto osd = std::make_shared<cvedix_lazy_osd_node<cvedix_face_osd_node>>("osd_0");
+    template<typename osd_node_t>
+    class cvedix_lazy_osd_node: public osd_node_t {
+    private:
+        cvedix_osd_consumer_cache consumers;
+        std::atomic<bool> rendering {true};
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            rendering = consumers.get(*this).count > 0;
+            if (!rendering) {
+                return meta;
+            }
+            return osd_node_t::handle_frame_meta(meta);
+        }
+
+    public:
+        template<typename... args_t>
+        cvedix_lazy_osd_node(args_t&&... args):
+                             osd_node_t(std::forward<args_t>(args)...) {}
+        ~cvedix_lazy_osd_node() = default;
+
+        // set before pipeline starts, nullptr keeps the default
+        void set_osd_consumer_checker(cvedix_osd_consumer_checker checker, cvedix_osd_size_query size_query = nullptr) {
+            consumers.set(checker, size_query);
+            if constexpr (cvedix_has_refresh_consumers<osd_node_t>::value) {
+                osd_node_t::set_osd_consumer_checker(checker, size_query);
+            }
+        }
+
+        // walk the graph again, call after nodes downstream are attached/detached while running (not on the node's thread)
+        void refresh_consumers() {
+            consumers.refresh(*this);
+            if constexpr (cvedix_has_refresh_consumers<osd_node_t>::value) {
+                osd_node_t::refresh_consumers();
+            }
+        }
+
+        // false if osd was skipped for latest frames
+        bool is_rendering() const {
+            return rendering;
+        }
+    };
+}
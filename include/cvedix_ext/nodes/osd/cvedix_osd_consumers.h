@@ -0,0 +1,150 @@
+#pragma once
+
+#include "cvedix/nodes/des/cvedix_des_node.h"
+#include "cvedix/nodes/des/cvedix_fake_des_node.h"
+#include "cvedix/nodes/des/cvedix_file_des_node.h"
+#include "cvedix/nodes/des/cvedix_rtmp_des_node.h"
+#include "cvedix/nodes/des/cvedix_rtsp_des_node.h"
+#include "cvedix/nodes/des/cvedix_screen_des_node.h"
+#include "cvedix/nodes/record/cvedix_record_node.h"
+#include "cvedix_ext/nodes/des/cvedix_multi_des_node.h"
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <type_traits>
+#include <utility>
+
+namespace cvedix_nodes {
+    // return true if node reads osd_frame of metas it receives
+    typedef std::function<bool(std::shared_ptr<cvedix_node>)> cvedix_osd_consumer_checker;
+    // size a consumer of osd_frame outputs it at (it scales osd_frame to that), empty size if it needs source resolution
+    typedef std::function<cv::Size(std::shared_ptr<cvedix_node>)> cvedix_osd_size_query;
+
+    // des nodes except cvedix_fake_des_node and des nodes created with osd = false, and record nodes
+    inline bool cvedix_default_osd_consumer_checker(std::shared_ptr<cvedix_node> node) {
+        if (std::dynamic_pointer_cast<cvedix_fake_des_node>(node)) {
+            return false;
+        }
+        if (auto screen = std::dynamic_pointer_cast<cvedix_screen_des_node>(node)) {
+            return screen->osd;
+        }
+        if (auto rtmp = std::dynamic_pointer_cast<cvedix_rtmp_des_node>(node)) {
+            return rtmp->osd;
+        }
+        if (auto rtsp = std::dynamic_pointer_cast<cvedix_rtsp_des_node>(node)) {
+            return rtsp->osd;
+        }
+        if (auto file = std::dynamic_pointer_cast<cvedix_file_des_node>(node)) {
+            return file->osd;
+        }
+        if (auto multi = std::dynamic_pointer_cast<cvedix_multi_des_node>(node)) {
+            return multi->get_osd();
+        }
+        return std::dynamic_pointer_cast<cvedix_des_node>(node) || std::dynamic_pointer_cast<cvedix_record_node>(node);
+    }
+
+    // output resolution of des nodes, source resolution for everything else (screen without display size, record, ...)
+    inline cv::Size cvedix_default_osd_size_query(std::shared_ptr<cvedix_node> node) {
+        cvedix_objects::cvedix_size size;
+        if (auto screen = std::dynamic_pointer_cast<cvedix_screen_des_node>(node)) {
+            size = screen->display_w_h;
+        }
+        else if (auto rtmp = std::dynamic_pointer_cast<cvedix_rtmp_des_node>(node)) {
+            size = rtmp->resolution_w_h;
+        }
+        else if (auto rtsp = std::dynamic_pointer_cast<cvedix_rtsp_des_node>(node)) {
+            size = rtsp->resolution_w_h;
+        }
+        else if (auto file = std::dynamic_pointer_cast<cvedix_file_des_node>(node)) {
+            size = file->resolution_w_h;
+        }
+        else if (auto multi = std::dynamic_pointer_cast<cvedix_multi_des_node>(node)) {
+            size = multi->get_resolution();
+        }
+        return cv::Size(size.width, size.height);
+    }
+
+    // who reads osd_frame downstream of a node
+    struct cvedix_osd_consumers {
+        int count = 0;
+        // smallest osd_frame serving every consumer (largest of their output sizes), empty if any of them needs
+        // source resolution or there is no consumer
+        cv::Size render_size;
+    };
+
+    // osd consumers downstream of a node, found by walking next_nodes() recursively. walking races with nodes being
+    // attached/detached, so it runs on the first frame and afterwards only when refresh(...) is called by whoever
+    // changed the graph, the node's thread reads the cached result.
+    class cvedix_osd_consumer_cache {
+    private:
+        cvedix_osd_consumer_checker checker = cvedix_default_osd_consumer_checker;
+        cvedix_osd_size_query size_query = cvedix_default_osd_size_query;
+        cvedix_osd_consumers consumers;
+        bool valid = false;
+        std::mutex lock;
+
+        void walk(const std::vector<std::shared_ptr<cvedix_node>>& nodes, std::set<cvedix_node*>& visited,
+                  cvedix_osd_consumers& found, bool& full_size) {
+            for (auto& node: nodes) {
+                if (!visited.insert(node.get()).second) {
+                    continue;
+                }
+                if (checker(node)) {
+                    auto size = size_query(node);
+                    full_size = full_size || size.empty();
+                    found.count++;
+                    found.render_size = cv::Size(std::max(found.render_size.width, size.width), std::max(found.render_size.height, size.height));
+                }
+                // nodes behind a consumer (record node, ...) may read osd_frame too
+                walk(node->next_nodes(), visited, found, full_size);
+            }
+        }
+
+        cvedix_osd_consumers find(cvedix_node& node) {
+            cvedix_osd_consumers found;
+            std::set<cvedix_node*> visited;
+            bool full_size = false;
+            walk(node.next_nodes(), visited, found, full_size);
+            if (full_size) {
+                found.render_size = cv::Size();
+            }
+            return found;
+        }
+
+    public:
+        // node's thread, walks on first call only
+        cvedix_osd_consumers get(cvedix_node& node) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!valid) {
+                consumers = find(node);
+                valid = true;
+            }
+            return consumers;
+        }
+
+        // after nodes downstream of `node` are attached/detached while running
+        void refresh(cvedix_node& node) {
+            std::lock_guard<std::mutex> guard(lock);
+            consumers = find(node);
+            valid = true;
+        }
+
+        // set before pipeline starts
+        void set(cvedix_osd_consumer_checker checker, cvedix_osd_size_query size_query) {
+            std::lock_guard<std::mutex> guard(lock);
+            this->checker = checker ? checker : cvedix_default_osd_consumer_checker;
+            this->size_query = size_query ? size_query : cvedix_default_osd_size_query;
+            valid = false;
+        }
+    };
+
+    // true if osd_node_t has refresh_consumers(), for osd wrappers forwarding it to wrapped wrappers
+    template<typename osd_node_t, typename = void>
+    struct cvedix_has_refresh_consumers: std::false_type {};
+    template<typename osd_node_t>
+    struct cvedix_has_refresh_consumers<osd_node_t, std::void_t<decltype(std::declval<osd_node_t&>().refresh_consumers())>>: std::true_type {};
+}
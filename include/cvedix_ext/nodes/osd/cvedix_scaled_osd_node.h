@@ -0,0 +1,167 @@
+#pragma once
+
+#include "cvedix_ext/nodes/osd/cvedix_osd_consumers.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace cvedix_nodes {
+    // wrap any osd node to draw at the resolution of the destinations (encoder output size of cvedix_rtmp_des_node,
+    // cvedix_rtsp_des_node, ...) instead of source resolution.
+    // the target size comes from the osd consumers downstream (cvedix_osd_consumer_cache, walked on the first frame
+    // and by refresh_consumers()): the largest output size among them, so no consumer gets less than it outputs.
+    // if any consumer needs source resolution (screen without display size, record node, ...) it draws at source
+    // resolution as usual, a screen branch never gets a downscaled frame.
+    // the frame is scaled once into a scratch frame meta which also gets scaled copies of everything osd nodes draw:
+    // targets and face targets (rects, tracks, sub targets, key points, masks), pose targets, text targets, ba
+    // results (regions/lines) and the frame mask, description is copied. the wrapped osd node draws on the scratch
+    // meta, only the resulting osd_frame (already at target size, des nodes do not scale it again) is written back.
+    // boxes and text are drawn at final pixel size (sharp text, less pixels to copy and draw). frame and targets of
+    // the shared meta are never touched, so nodes reading them concurrently (brokers cropping on their own threads
+    // upstream, anything downstream) always see source resolution.
+    // frames not larger than the target size are drawn as they are.
+    //
+    // usage:
+    // auto osd = std::make_shared<cvedix_scaled_osd_node<cvedix_face_osd_node>>("osd_0");
+    // can be combined with cvedix_lazy_osd_node: cvedix_lazy_osd_node<cvedix_scaled_osd_node<cvedix_face_osd_node>>.
+    template<typename osd_node_t>
+    class cvedix_scaled_osd_node: public osd_node_t {
+    private:
+        cvedix_osd_consumer_cache consumers;
+        cv::Size fixed_size;
+
+        static cvedix_objects::cvedix_rect scale_rect(const cvedix_objects::cvedix_rect& r, double fx, double fy) {
+            return cvedix_objects::cvedix_rect(r.x * fx, r.y * fy, r.width * fx, r.height * fy);
+        }
+
+        // geometry shared by all target kinds
+        template<typename target_t>
+        static void scale_box(target_t& t, double fx, double fy) {
+            t.x = static_cast<int>(t.x * fx);
+            t.y = static_cast<int>(t.y * fy);
+            t.width = static_cast<int>(t.width * fx);
+            t.height = static_cast<int>(t.height * fy);
+            for (auto& r: t.tracks) {
+                r = scale_rect(r, fx, fy);
+            }
+        }
+
+        static std::shared_ptr<cvedix_objects::cvedix_frame_target> scaled_copy(cvedix_objects::cvedix_frame_target& target, double fx, double fy) {
+            auto t = target.clone();    // only reads target
+            scale_box(*t, fx, fy);
+            // clone() shares sub targets, copy them before scaling
+            for (auto& s: t->sub_targets) {
+                auto sub = std::make_shared<cvedix_objects::cvedix_sub_target>(*s);
+                sub->x = static_cast<int>(sub->x * fx);
+                sub->y = static_cast<int>(sub->y * fy);
+                sub->width = static_cast<int>(sub->width * fx);
+                sub->height = static_cast<int>(sub->height * fy);
+                s = sub;
+            }
+            if (!t->mask.empty() && t->width > 0 && t->height > 0) {
+                cv::Mat mask;
+                cv::resize(t->mask, mask, cv::Size(t->width, t->height), 0, 0, cv::INTER_NEAREST);
+                t->mask = mask;
+            }
+            return t;
+        }
+
+        static std::shared_ptr<cvedix_objects::cvedix_frame_face_target> scaled_copy(cvedix_objects::cvedix_frame_face_target& target, double fx, double fy) {
+            auto t = target.clone();    // only reads target
+            scale_box(*t, fx, fy);
+            for (auto& p: t->key_points) {
+                p = {static_cast<int>(p.first * fx), static_cast<int>(p.second * fy)};
+            }
+            return t;
+        }
+
+        static std::shared_ptr<cvedix_objects::cvedix_frame_pose_target> scaled_copy(cvedix_objects::cvedix_frame_pose_target& target, double fx, double fy) {
+            auto t = std::make_shared<cvedix_objects::cvedix_frame_pose_target>(target);
+            for (auto& p: t->key_points) {
+                p.x = static_cast<int>(p.x * fx);
+                p.y = static_cast<int>(p.y * fy);
+            }
+            return t;
+        }
+
+        static std::shared_ptr<cvedix_objects::cvedix_frame_text_target> scaled_copy(cvedix_objects::cvedix_frame_text_target& target, double fx, double fy) {
+            auto t = std::make_shared<cvedix_objects::cvedix_frame_text_target>(target);
+            for (auto& v: t->region_vertexes) {
+                v = {static_cast<int>(v.first * fx), static_cast<int>(v.second * fy)};
+            }
+            return t;
+        }
+
+        static std::shared_ptr<cvedix_objects::cvedix_ba_result> scaled_copy(cvedix_objects::cvedix_ba_result& result, double fx, double fy) {
+            auto r = std::make_shared<cvedix_objects::cvedix_ba_result>(result);
+            for (auto& p: r->involve_region_in_frame) {
+                p = cvedix_objects::cvedix_point(static_cast<int>(p.x * fx), static_cast<int>(p.y * fy));
+            }
+            return r;
+        }
+
+        template<typename item_t>
+        static void scale_all(const std::vector<std::shared_ptr<item_t>>& from, std::vector<std::shared_ptr<item_t>>& to, double fx, double fy) {
+            to.reserve(from.size());
+            for (auto& item: from) {
+                to.push_back(scaled_copy(*item, fx, fy));
+            }
+        }
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            auto target_size = fixed_size.empty() ? consumers.get(*this).render_size : fixed_size;
+            if (target_size.empty() || !meta->osd_frame.empty() ||
+                (meta->frame.cols <= target_size.width && meta->frame.rows <= target_size.height)) {
+                return osd_node_t::handle_frame_meta(meta);
+            }
+
+            auto fx = static_cast<double>(target_size.width) / meta->frame.cols;
+            auto fy = static_cast<double>(target_size.height) / meta->frame.rows;
+            cv::Mat scaled_frame;
+            cv::resize(meta->frame, scaled_frame, target_size, 0, 0, cv::INTER_AREA);
+
+            // scratch meta at target size, meta itself is only read
+            auto scaled = std::make_shared<cvedix_objects::cvedix_frame_meta>(scaled_frame, meta->frame_index, meta->channel_index,
+                                                                              meta->original_width, meta->original_height, meta->fps);
+            scale_all(meta->targets, scaled->targets, fx, fy);
+            scale_all(meta->face_targets, scaled->face_targets, fx, fy);
+            scale_all(meta->pose_targets, scaled->pose_targets, fx, fy);
+            scale_all(meta->text_targets, scaled->text_targets, fx, fy);
+            scale_all(meta->ba_results, scaled->ba_results, fx, fy);
+            scaled->description = meta->description;
+            if (!meta->mask.empty()) {
+                cv::resize(meta->mask, scaled->mask, target_size, 0, 0, cv::INTER_NEAREST);
+            }
+
+            osd_node_t::handle_frame_meta(scaled);
+            meta->osd_frame = scaled->osd_frame;
+            return meta;
+        }
+
+    public:
+        template<typename... args_t>
+        cvedix_scaled_osd_node(args_t&&... args):
+                               osd_node_t(std::forward<args_t>(args)...) {}
+        ~cvedix_scaled_osd_node() = default;
+
+        // set before pipeline starts, nullptr keeps the default
+        void set_osd_consumer_checker(cvedix_osd_consumer_checker checker, cvedix_osd_size_query size_query = nullptr) {
+            consumers.set(checker, size_query);
+        }
+
+        // walk the graph again, call after nodes downstream are attached/detached while running (not on the node's thread)
+        void refresh_consumers() {
+            consumers.refresh(*this);
+        }
+
+        // draw at `size` whatever the consumers are (custom des nodes the size query does not know), set before
+        // pipeline starts. empty size goes back to the consumers' size
+        void set_target_size(cv::Size size) {
+            fixed_size = size;
+        }
+    };
+}
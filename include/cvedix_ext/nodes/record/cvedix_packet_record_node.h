@@ -0,0 +1,434 @@
+#pragma once
+
+#include "cvedix/nodes/cvedix_node.h"
+#include "cvedix/nodes/record/cvedix_record_node.h"
+#include "cvedix/objects/cvedix_image_record_control_meta.h"
+#include "cvedix/objects/cvedix_video_record_control_meta.h"
+#include "cvedix/utils/cvedix_utils.h"
+#include "cvedix/utils/logger/cvedix_logger.h"
+#include "cvedix_ext/nodes/record/packet/cvedix_packet_ring.h"
+#include "cvedix_ext/utils/cvedix_async_file_writer.h"
+
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+#include <opencv2/imgcodecs.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cvedix_nodes {
+    typedef std::function<void(int, cvedix_record_info)> cvedix_packet_record_complete_hooker;
+
+    // video recording with pre-roll kept as encoded packets.
+    // cvedix_record_node keeps raw frames for pre-roll (width x height x 3 bytes per frame), this node encodes every
+    // channel once to H.264 (gstreamer, x264enc) and keeps the last `pre_record_seconds` as a cvedix_packet_ring aligned
+    // to keyframes, memory per channel is about bitrate x seconds.
+    // on trigger a clip takes the buffered packets (from the keyframe at or before now - pre_record_seconds) plus live
+    // packets until the record duration is reached, then it is handed to a cvedix_utils::cvedix_async_file_writer:
+    // remuxed to mp4 (without re-encoding) and written on its I/O thread, and the complete hooker is called there.
+    // one writer can be shared with other record/image nodes, so all file output of a box goes through one I/O thread.
+    // image records (jpeg of the next frame of the channel) are encoded and written on the same writer, so the node
+    // replaces cvedix_record_node for both kinds.
+    //
+    // triggers are the same as for cvedix_record_node: cvedix_src_node::record_video_manually(...) and
+    // record_image_manually(...) (record control metas flowing through the pipeline), or record_video(...) and
+    // record_image(...) directly. metas pass through unchanged.
+    class cvedix_packet_record_node: public cvedix_node {
+    private:
+        struct clip {
+            cvedix_record_info info;
+            int64_t end_pts = 0;
+            std::vector<std::shared_ptr<const cvedix_encoded_packet>> packets;
+        };
+
+        struct channel_encoder {
+            GstElement* pipeline = nullptr;
+            GstElement* src = nullptr;
+            GstElement* sink = nullptr;
+            int width = 0;
+            int height = 0;
+            int64_t frame_duration = 0;
+            std::unique_ptr<cvedix_packet_ring> ring;
+            std::vector<clip> clips;        // recording in progress
+        };
+
+        struct image_request {
+            std::string file_name_without_ext;
+            bool osd;
+        };
+
+        std::string video_save_dir;
+        std::string image_save_dir;
+        double pre_record_seconds;
+        int bitrate;
+        int key_int;
+        bool osd;
+        std::map<int, std::unique_ptr<channel_encoder>> encoders;
+        std::map<int, std::vector<image_request>> image_requests;   // taken by the next frame of the channel
+        std::mutex encoders_lock;           // node's thread and callers of record_video(...) / record_image(...)
+
+        std::shared_ptr<cvedix_utils::cvedix_async_file_writer> writer;
+        cvedix_packet_record_complete_hooker video_record_complete_hooker;
+        cvedix_packet_record_complete_hooker image_record_complete_hooker;
+
+        bool open_encoder(channel_encoder& e, int width, int height, int fps) {
+            auto description = cvedix_utils::string_format(
+                "appsrc name=src is-live=true format=time caps=video/x-raw,format=BGR,width=%d,height=%d,framerate=%d/1 ! "
+                "videoconvert ! x264enc bitrate=%d tune=zerolatency speed-preset=ultrafast key-int-max=%d ! "
+                "h264parse config-interval=-1 ! video/x-h264,stream-format=byte-stream,alignment=au ! appsink name=sink sync=false",
+                width, height, fps, bitrate, key_int);
+            GError* error = nullptr;
+            e.pipeline = gst_parse_launch(description.c_str(), &error);
+            if (!e.pipeline || error) {
+                CVEDIX_ERROR(cvedix_utils::string_format("[%s] create encoder failed: %s", node_name.c_str(), error ? error->message : description.c_str()));
+                if (error) g_error_free(error);
+                if (e.pipeline) gst_object_unref(e.pipeline);
+                e.pipeline = nullptr;
+                return false;
+            }
+            e.src = gst_bin_get_by_name(GST_BIN(e.pipeline), "src");
+            e.sink = gst_bin_get_by_name(GST_BIN(e.pipeline), "sink");
+            gst_element_set_state(e.pipeline, GST_STATE_PLAYING);
+            e.width = width;
+            e.height = height;
+            e.frame_duration = GST_SECOND / fps;
+            return true;
+        }
+
+        static void close_encoder(channel_encoder& e) {
+            if (!e.pipeline) {
+                return;
+            }
+            gst_element_set_state(e.pipeline, GST_STATE_NULL);
+            gst_object_unref(e.src);
+            gst_object_unref(e.sink);
+            gst_object_unref(e.pipeline);
+            e.pipeline = nullptr;
+        }
+
+        // encoded packets ready after pushing a frame (x264enc with zerolatency does not hold frames back)
+        void pull_packets(channel_encoder& e, int64_t fallback_pts, std::vector<std::shared_ptr<const cvedix_encoded_packet>>& out) {
+            while (auto sample = gst_app_sink_try_pull_sample(GST_APP_SINK(e.sink), 0)) {
+                auto buffer = gst_sample_get_buffer(sample);
+                GstMapInfo map;
+                if (buffer && gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+                    auto packet = std::make_shared<cvedix_encoded_packet>();
+                    packet->data.assign(map.data, map.data + map.size);
+                    packet->pts = GST_BUFFER_PTS_IS_VALID(buffer) ? GST_BUFFER_PTS(buffer) : fallback_pts;
+                    packet->duration = GST_BUFFER_DURATION_IS_VALID(buffer) ? GST_BUFFER_DURATION(buffer) : e.frame_duration;
+                    packet->keyframe = !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+                    gst_buffer_unmap(buffer, &map);
+                    out.push_back(packet);
+                }
+                gst_sample_unref(sample);
+            }
+        }
+
+        void start_clip(int channel_index, const std::string& file_name_without_ext, int record_seconds) {
+            auto it = encoders.find(channel_index);
+            if (it == encoders.end()) {
+                CVEDIX_WARN(cvedix_utils::string_format("[%s] no frames of channel %d yet, record ignored", node_name.c_str(), channel_index));
+                return;
+            }
+            auto& e = *it->second;
+            clip c;
+            c.info.channel_index = channel_index;
+            c.info.file_name_without_ext = file_name_without_ext;
+            c.info.full_record_path = video_save_dir + "/" + file_name_without_ext + ".mp4";
+            c.info.record_type = cvedix_record_type::VIDEO;
+            auto now = e.ring->newest_pts();
+            c.packets = e.ring->since(now - static_cast<int64_t>(pre_record_seconds * GST_SECOND));
+            c.end_pts = now + static_cast<int64_t>(record_seconds) * GST_SECOND;
+            e.clips.push_back(std::move(c));
+        }
+
+        // remux packets to an mp4 in memory (I/O thread), empty if failed. faststart puts moov first, so mp4mux
+        // does not need to seek back in its output
+        static std::vector<uint8_t> mux_clip(const std::string& node_name, const clip& c) {
+            std::vector<uint8_t> mp4;
+            auto description = "appsrc name=src format=time caps=video/x-h264,stream-format=byte-stream,alignment=au ! "
+                               "h264parse ! mp4mux faststart=true ! appsink name=sink sync=false";
+            GError* error = nullptr;
+            auto pipeline = gst_parse_launch(description, &error);
+            if (!pipeline || error) {
+                CVEDIX_ERROR(cvedix_utils::string_format("[%s] create muxer failed: %s", node_name.c_str(), error ? error->message : description));
+                if (error) g_error_free(error);
+                if (pipeline) gst_object_unref(pipeline);
+                return mp4;
+            }
+            auto src = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+            auto sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+            gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+            auto base = c.packets.front()->pts;
+            for (auto& p: c.packets) {
+                auto buffer = gst_buffer_new_allocate(nullptr, p->data.size(), nullptr);
+                gst_buffer_fill(buffer, 0, p->data.data(), p->data.size());
+                GST_BUFFER_PTS(buffer) = GST_BUFFER_DTS(buffer) = p->pts - base;
+                GST_BUFFER_DURATION(buffer) = p->duration;
+                if (!p->keyframe) {
+                    GST_BUFFER_FLAG_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+                }
+                gst_app_src_push_buffer(GST_APP_SRC(src), buffer);
+            }
+            gst_app_src_end_of_stream(GST_APP_SRC(src));
+
+            // collect muxed output until mp4 is finalized (EOS reaches the sink), an error never gets there
+            auto bus = gst_element_get_bus(pipeline);
+            while (true) {
+                if (auto sample = gst_app_sink_try_pull_sample(GST_APP_SINK(sink), 100 * GST_MSECOND)) {
+                    auto buffer = gst_sample_get_buffer(sample);
+                    GstMapInfo map;
+                    if (buffer && gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+                        mp4.insert(mp4.end(), map.data, map.data + map.size);
+                        gst_buffer_unmap(buffer, &map);
+                    }
+                    gst_sample_unref(sample);
+                    continue;
+                }
+                if (gst_app_sink_is_eos(GST_APP_SINK(sink))) {
+                    break;
+                }
+                if (auto message = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR)) {
+                    mp4.clear();
+                    gst_message_unref(message);
+                    break;
+                }
+            }
+            gst_object_unref(bus);
+            gst_element_set_state(pipeline, GST_STATE_NULL);
+            gst_object_unref(src);
+            gst_object_unref(sink);
+            gst_object_unref(pipeline);
+            return mp4;
+        }
+
+        // called with encoders_lock held, muxing and writing happen on the writer's I/O thread
+        void finish_clip(clip&& c) {
+            if (c.packets.empty()) {
+                CVEDIX_WARN(cvedix_utils::string_format("[%s] nothing to write for %s", node_name.c_str(), c.info.full_record_path.c_str()));
+                return;
+            }
+            // captured by value, the writer can outlive this node
+            auto name = node_name;
+            auto hooker = video_record_complete_hooker;
+            auto muxed = std::make_shared<bool>(false);
+            auto shared_clip = std::make_shared<clip>(std::move(c));
+            auto info = shared_clip->info;
+            size_t clip_bytes = 0;
+            for (auto& p: shared_clip->packets) {
+                clip_bytes += p->data.size();
+            }
+            auto accepted = writer->submit(info.full_record_path,
+                [name, shared_clip, muxed]() {
+                    auto mp4 = mux_clip(name, *shared_clip);
+                    *muxed = !mp4.empty();
+                    return mp4;
+                },
+                clip_bytes,
+                [name, info, hooker, muxed](const std::string& path, bool ok) {
+                    if (!ok || !*muxed) {
+                        if (!*muxed) {
+                            unlink(path.c_str());   // nothing muxed, an empty file was written
+                        }
+                        CVEDIX_ERROR(cvedix_utils::string_format("[%s] write %s failed", name.c_str(), path.c_str()));
+                        return;
+                    }
+                    if (hooker) {
+                        hooker(info.channel_index, info);
+                    }
+                });
+            if (!accepted) {
+                CVEDIX_WARN(cvedix_utils::string_format("[%s] I/O queue full, clip %s dropped", node_name.c_str(), info.full_record_path.c_str()));
+            }
+        }
+
+        // called with encoders_lock held, jpeg encoding and writing happen on the writer's I/O thread
+        void save_images(const cvedix_objects::cvedix_frame_meta& meta, std::vector<image_request>& requests) {
+            for (auto& r: requests) {
+                auto& source = (r.osd && !meta.osd_frame.empty()) ? meta.osd_frame : meta.frame;
+                if (source.empty()) {
+                    continue;
+                }
+                // frame may still be drawn on by other nodes while the I/O thread encodes
+                auto image = source.clone();
+                cvedix_record_info info;
+                info.channel_index = meta.channel_index;
+                info.file_name_without_ext = r.file_name_without_ext;
+                info.full_record_path = image_save_dir + "/" + r.file_name_without_ext + ".jpg";
+                info.record_type = cvedix_record_type::IMAGE;
+                auto name = node_name;
+                auto hooker = image_record_complete_hooker;
+                auto accepted = writer->submit(info.full_record_path,
+                    [image]() {
+                        std::vector<uint8_t> buffer;
+                        cv::imencode(".jpg", image, buffer);
+                        return buffer;
+                    },
+                    image.total() * image.elemSize(),
+                    [name, info, hooker](const std::string& path, bool ok) {
+                        if (!ok) {
+                            CVEDIX_ERROR(cvedix_utils::string_format("[%s] write %s failed", name.c_str(), path.c_str()));
+                            return;
+                        }
+                        if (hooker) {
+                            hooker(info.channel_index, info);
+                        }
+                    });
+                if (!accepted) {
+                    CVEDIX_WARN(cvedix_utils::string_format("[%s] I/O queue full, image %s dropped", node_name.c_str(), info.full_record_path.c_str()));
+                }
+            }
+            requests.clear();
+        }
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            std::lock_guard<std::mutex> guard(encoders_lock);
+            auto requests = image_requests.find(meta->channel_index);
+            if (requests != image_requests.end() && !requests->second.empty()) {
+                save_images(*meta, requests->second);
+            }
+
+            auto& frame = (meta->osd_frame.empty() || !osd) ? meta->frame : meta->osd_frame;
+            if (frame.empty()) {
+                return meta;
+            }
+            auto fps = meta->fps > 0 ? meta->fps : 25;
+
+            auto& e = encoders[meta->channel_index];
+            if (!e) {
+                e = std::make_unique<channel_encoder>();
+                // hard cap: twice the expected size of pre-roll plus one GOP
+                auto bytes = static_cast<size_t>(bitrate) * 125 * static_cast<size_t>(pre_record_seconds + key_int / fps + 1) * 2;
+                e->ring = std::make_unique<cvedix_packet_ring>(pre_record_seconds, bytes);
+            }
+            if (e->pipeline && (e->width != frame.cols || e->height != frame.rows)) {
+                close_encoder(*e);      // resolution changed, start a new stream (clips keep what they have)
+                e->ring->clear();
+            }
+            if (!e->pipeline && !open_encoder(*e, frame.cols, frame.rows, fps)) {
+                return meta;
+            }
+
+            auto size = frame.total() * frame.elemSize();
+            auto buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
+            if (frame.isContinuous()) {
+                gst_buffer_fill(buffer, 0, frame.data, size);
+            }
+            else {
+                auto continuous = frame.clone();
+                gst_buffer_fill(buffer, 0, continuous.data, size);
+            }
+            auto pts = static_cast<int64_t>(meta->frame_index) * e->frame_duration;
+            GST_BUFFER_PTS(buffer) = pts;
+            GST_BUFFER_DURATION(buffer) = e->frame_duration;
+            gst_app_src_push_buffer(GST_APP_SRC(e->src), buffer);
+
+            std::vector<std::shared_ptr<const cvedix_encoded_packet>> packets;
+            pull_packets(*e, pts, packets);
+            for (auto& p: packets) {
+                e->ring->push(p);
+                for (auto c = e->clips.begin(); c != e->clips.end();) {
+                    // clips triggered before the first keyframe start at the next keyframe
+                    if (!c->packets.empty() || p->keyframe) {
+                        c->packets.push_back(p);
+                    }
+                    if (p->pts >= c->end_pts) {
+                        finish_clip(std::move(*c));
+                        c = e->clips.erase(c);
+                    }
+                    else {
+                        c++;
+                    }
+                }
+            }
+            return meta;
+        }
+
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_control_meta(std::shared_ptr<cvedix_objects::cvedix_control_meta> meta) override {
+            if (auto record = std::dynamic_pointer_cast<cvedix_objects::cvedix_video_record_control_meta>(meta)) {
+                std::lock_guard<std::mutex> guard(encoders_lock);
+                start_clip(record->channel_index, record->video_file_name_without_ext, record->record_video_duration);
+            }
+            else if (auto record = std::dynamic_pointer_cast<cvedix_objects::cvedix_image_record_control_meta>(meta)) {
+                record_image(record->channel_index, record->image_file_name_without_ext, record->osd);
+            }
+            return meta;
+        }
+
+    public:
+        cvedix_packet_record_node(std::string node_name,
+                                  std::string video_save_dir,
+                                  std::string image_save_dir,
+                                  double pre_record_seconds = 5,
+                                  int bitrate = 2048,
+                                  int key_int = 25,
+                                  bool osd = false,
+                                  std::shared_ptr<cvedix_utils::cvedix_async_file_writer> writer = nullptr):
+                                  cvedix_node(node_name),
+                                  video_save_dir(video_save_dir),
+                                  image_save_dir(image_save_dir),
+                                  pre_record_seconds(pre_record_seconds),
+                                  bitrate(bitrate),
+                                  key_int(key_int),
+                                  osd(osd),
+                                  writer(writer ? writer : std::make_shared<cvedix_utils::cvedix_async_file_writer>()) {
+            if (!gst_is_initialized()) {
+                gst_init(nullptr, nullptr);
+            }
+            this->initialized();
+        }
+        ~cvedix_packet_record_node() {
+            {
+                std::lock_guard<std::mutex> guard(encoders_lock);
+                for (auto& [_, e]: encoders) {
+                    // write what is recorded so far
+                    for (auto& c: e->clips) {
+                        finish_clip(std::move(c));
+                    }
+                    e->clips.clear();
+                    close_encoder(*e);
+                }
+            }
+            // a private writer finishes queued clips when released here, a shared one keeps them
+        }
+
+        // set before pipeline starts, called on the writer's I/O thread when a clip is written
+        void set_video_record_complete_hooker(cvedix_packet_record_complete_hooker hooker) {
+            video_record_complete_hooker = hooker;
+        }
+
+        // set before pipeline starts, called on the writer's I/O thread when an image is written
+        void set_image_record_complete_hooker(cvedix_packet_record_complete_hooker hooker) {
+            image_record_complete_hooker = hooker;
+        }
+
+        // save the next frame of channel as jpeg (osd_frame if `osd` and present), thread-safe
+        void record_image(int channel_index, const std::string& file_name_without_ext, bool osd = false) {
+            std::lock_guard<std::mutex> guard(encoders_lock);
+            image_requests[channel_index].push_back({file_name_without_ext, osd});
+        }
+
+        // record `record_seconds` of channel from now on, plus pre-roll, thread-safe
+        void record_video(int channel_index, const std::string& file_name_without_ext, int record_seconds = 10) {
+            std::lock_guard<std::mutex> guard(encoders_lock);
+            start_clip(channel_index, file_name_without_ext, record_seconds);
+        }
+
+        std::shared_ptr<cvedix_utils::cvedix_async_file_writer> get_writer() {
+            return writer;
+        }
+
+        // bytes of pre-roll held for channel, for monitoring
+        size_t buffered_bytes(int channel_index) {
+            std::lock_guard<std::mutex> guard(encoders_lock);
+            auto it = encoders.find(channel_index);
+            return it == encoders.end() ? 0 : it->second->ring->bytes();
+        }
+    };
+}
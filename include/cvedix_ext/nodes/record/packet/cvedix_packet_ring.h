@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace cvedix_nodes {
+    // one encoded access unit (H.264 byte-stream, all NALs of one frame)
+    struct cvedix_encoded_packet {
+        std::vector<uint8_t> data;
+        int64_t pts = 0;            // nanoseconds
+        int64_t duration = 0;       // nanoseconds
+        bool keyframe = false;
+    };
+
+    // pre-event history of one stream as encoded packets, memory is bounded by bitrate x seconds instead of
+    // width x height x 3 x fps x seconds for raw frames.
+    // the ring always starts with a keyframe: whole GOPs are evicted from the front once the history is longer than
+    // `max_seconds` (the GOP containing now - max_seconds is kept, so a clip can start at or before it) or larger
+    // than `max_bytes` (hard cap, may cut pre-roll short at very high bitrate).
+    // packets are immutable and shared, clips taken from the ring do not copy data.
+    // not thread-safe.
+    class cvedix_packet_ring {
+    private:
+        std::deque<std::shared_ptr<const cvedix_encoded_packet>> packets;
+        int64_t max_duration;
+        size_t max_bytes;
+        size_t total_bytes = 0;
+
+        // position of the second keyframe, 0 if there is only one GOP
+        size_t second_gop() const {
+            for (size_t i = 1; i < packets.size(); i++) {
+                if (packets[i]->keyframe) {
+                    return i;
+                }
+            }
+            return 0;
+        }
+
+        void drop_front(size_t n) {
+            for (size_t i = 0; i < n; i++) {
+                total_bytes -= packets.front()->data.size();
+                packets.pop_front();
+            }
+        }
+
+    public:
+        cvedix_packet_ring(double max_seconds, size_t max_bytes):
+                           max_duration(static_cast<int64_t>(max_seconds * 1e9)), max_bytes(max_bytes) {}
+
+        void push(std::shared_ptr<const cvedix_encoded_packet> packet) {
+            // nothing to decode before the first keyframe
+            if (packets.empty() && !packet->keyframe) {
+                return;
+            }
+            total_bytes += packet->data.size();
+            packets.push_back(packet);
+
+            while (true) {
+                auto next = second_gop();
+                if (next == 0) {
+                    break;
+                }
+                // drop the oldest GOP if the rest still covers max_seconds, or if over memory cap
+                auto covered = packets.back()->pts - packets[next]->pts;
+                if (covered >= max_duration || total_bytes > max_bytes) {
+                    drop_front(next);
+                }
+                else {
+                    break;
+                }
+            }
+            // a single GOP over the memory cap can not be kept decodable, start over at the next keyframe
+            if (total_bytes > max_bytes && second_gop() == 0 && packets.size() > 1) {
+                drop_front(packets.size());
+            }
+        }
+
+        // packets from the last keyframe at or before `pts` (or the oldest keyframe) to the newest one
+        std::vector<std::shared_ptr<const cvedix_encoded_packet>> since(int64_t pts) const {
+            size_t start = 0;
+            for (size_t i = 0; i < packets.size() && packets[i]->pts <= pts; i++) {
+                if (packets[i]->keyframe) {
+                    start = i;
+                }
+            }
+            return {packets.begin() + start, packets.end()};
+        }
+
+        int64_t newest_pts() const {
+            return packets.empty() ? 0 : packets.back()->pts;
+        }
+
+        // seconds of history available
+        double seconds() const {
+            return packets.empty() ? 0 : (packets.back()->pts + packets.back()->duration - packets.front()->pts) / 1e9;
+        }
+
+        size_t bytes() const {
+            return total_bytes;
+        }
+
+        size_t size() const {
+            return packets.size();
+        }
+
+        void clear() {
+            packets.clear();
+            total_bytes = 0;
+        }
+    };
+}
@@ -0,0 +1,259 @@
+#pragma once
+
+#include "cvedix/nodes/src/cvedix_src_node.h"
+#include "cvedix/objects/cvedix_frame_meta.h"
+#include "cvedix/utils/cvedix_utils.h"
+#include "cvedix/utils/logger/cvedix_logger.h"
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cvedix_nodes {
+    // called with the data pointer once the pipeline dropped its last reference to an external frame
+    typedef std::function<void(void*)> cvedix_frame_release_callback;
+
+    // receive frames (cv::Mat) from host code like cvedix_app_src_node, for capture stacks that own their buffers:
+    // 1. push_frame(std::move(frame), ...) takes the caller's cv::Mat as is, no pixel copy and no vector copy.
+    // 2. push_external(data, ...) wraps memory of a decoder pool / dma buffer in a cv::Mat without copying, and calls
+    //    `release(data)` when the last reference inside the pipeline is gone (frame meta freed, all nodes done).
+    //    the buffer can go back to the pool then, see cvedix_external_frame_allocator.
+    // 3. the node holds at most `capacity` frames: frames waiting in its queue plus external frames not released yet.
+    //    push blocks up to `timeout_ms` while full (0: fail at once, -1: wait), free_capacity() tells how many frames
+    //    can be pushed without waiting. bounded memory and real backpressure instead of a growing queue.
+    //
+    // usage:
+    // auto app_src_0 = std::make_shared<cvedix_app_src_node_v2>("app_src_0", 0, 8);
+    // app_src_0->push_frame(std::move(frame), 100);
+    // app_src_0->push_external(nv12_ptr, 1080 * 3 / 2, 1920, CV_8UC1, pitch, [pool](void* p) { pool->put_back(p); }, -1);
+    class cvedix_app_src_node_v2: public cvedix_src_node {
+    private:
+        // shared with external frames, which can outlive the node
+        struct capacity_state {
+            std::mutex lock;
+            std::condition_variable changed;
+            size_t held = 0;        // queued + external in flight
+            size_t capacity;
+            explicit capacity_state(size_t capacity): capacity(capacity) {}
+
+            void release_slot() {
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    held--;
+                }
+                changed.notify_all();
+            }
+        };
+
+        // owner of an external buffer, userdata of its cv::UMatData
+        struct external_buffer {
+            void* data;
+            cvedix_frame_release_callback release;
+            std::shared_ptr<capacity_state> state;
+        };
+
+        // matrix allocator of external frames: never allocates, deallocate() hands the buffer back to its owner.
+        // set on UMatData only (not on cv::Mat::allocator), so create()/clone() of such a mat use the default one
+        class cvedix_external_frame_allocator: public cv::MatAllocator {
+        public:
+            virtual cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                                           cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+                return cv::Mat::getDefaultAllocator()->allocate(dims, sizes, type, data, step, flags, usage);
+            }
+            virtual bool allocate(cv::UMatData* u, cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+                return cv::Mat::getDefaultAllocator()->allocate(u, flags, usage);
+            }
+            virtual void deallocate(cv::UMatData* u) const override {
+                if (!u) {
+                    return;
+                }
+                auto buffer = static_cast<external_buffer*>(u->userdata);
+                if (buffer) {
+                    if (buffer->release) {
+                        buffer->release(buffer->data);
+                    }
+                    buffer->state->release_slot();
+                    delete buffer;
+                }
+                delete u;
+            }
+
+            static cvedix_external_frame_allocator* get() {
+                static cvedix_external_frame_allocator allocator;
+                return &allocator;
+            }
+        };
+
+        struct queued_frame {
+            cv::Mat frame;
+            bool external;
+        };
+
+        int fps;
+        std::shared_ptr<capacity_state> state;
+        std::deque<queued_frame> frames_to_handle;     // guarded by state->lock
+
+        // take a slot, waiting up to timeout_ms (-1 forever) while full
+        bool acquire_slot(int timeout_ms) {
+            std::unique_lock<std::mutex> guard(state->lock);
+            auto has_room = [&]() { return state->held < state->capacity; };
+            if (timeout_ms < 0) {
+                state->changed.wait(guard, has_room);
+            }
+            else if (!state->changed.wait_for(guard, std::chrono::milliseconds(timeout_ms), has_room)) {
+                return false;
+            }
+            state->held++;
+            return true;
+        }
+
+        bool enqueue(cv::Mat&& frame, bool external, int timeout_ms) {
+            if (!gate.is_open()) {
+                CVEDIX_WARN(cvedix_utils::string_format("[%s] not started, frame is ignored", node_name.c_str()));
+                return false;
+            }
+            if (!acquire_slot(timeout_ms)) {
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> guard(state->lock);
+                frames_to_handle.push_back({std::move(frame), external});
+            }
+            state->changed.notify_all();
+            return true;
+        }
+
+    protected:
+        virtual void handle_run() override {
+            while (alive) {
+                // check if need work
+                gate.knock();
+
+                queued_frame next;
+                {
+                    std::unique_lock<std::mutex> guard(state->lock);
+                    // wake up regularly to see `alive`
+                    if (!state->changed.wait_for(guard, std::chrono::milliseconds(100), [&]() { return !frames_to_handle.empty(); })) {
+                        continue;
+                    }
+                    next = std::move(frames_to_handle.front());
+                    frames_to_handle.pop_front();
+                }
+                // owned frames leave the node here, external ones when their buffer is released
+                if (!next.external) {
+                    state->release_slot();
+                }
+                if (next.frame.empty()) {
+                    continue;
+                }
+
+                this->frame_index++;
+                auto out_meta = std::make_shared<cvedix_objects::cvedix_frame_meta>(next.frame, this->frame_index, this->channel_index,
+                                                                                     next.frame.cols, next.frame.rows, fps);
+                next.frame.release();   // the meta holds the only reference now
+                this->out_queue.push(out_meta);
+                // handled hooker activated if need
+                if (this->meta_handled_hooker) {
+                    meta_handled_hooker(node_name, out_queue.size(), out_meta);
+                }
+                // notify consumer of out_queue in case it is waiting
+                this->out_queue_semaphore.signal();
+            }
+
+            // send dead flag for dispatch_thread
+            this->out_queue.push(nullptr);
+            this->out_queue_semaphore.signal();
+        }
+
+    public:
+        // capacity: frames held by the node (queued + external frames not yet released). fps: written to frame metas
+        cvedix_app_src_node_v2(std::string node_name, int channel_index, size_t capacity = 8, int fps = 25):
+                               cvedix_src_node(node_name, channel_index),
+                               fps(fps),
+                               state(std::make_shared<capacity_state>(capacity > 0 ? capacity : 1)) {
+            this->initialized();
+        }
+        ~cvedix_app_src_node_v2() {
+            this->deinitialized();
+            // frames nobody will handle, external ones are released with their mats (outside the lock, release takes it)
+            std::deque<queued_frame> left;
+            {
+                std::lock_guard<std::mutex> guard(state->lock);
+                left.swap(frames_to_handle);
+                for (auto& f: left) {
+                    if (!f.external) {
+                        state->held--;
+                    }
+                }
+            }
+            left.clear();
+        }
+
+        // take ownership of `frame` (no copy). false if not started, or still full after timeout_ms
+        bool push_frame(cv::Mat&& frame, int timeout_ms = 0) {
+            return enqueue(std::move(frame), false, timeout_ms);
+        }
+
+        // push in order, stops at the first frame not accepted. returns number of frames taken, taken ones are moved out
+        size_t push_frames(std::vector<cv::Mat>&& frames, int timeout_ms = 0) {
+            size_t taken = 0;
+            while (taken < frames.size() && push_frame(std::move(frames[taken]), timeout_ms)) {
+                taken++;
+            }
+            return taken;
+        }
+
+        // wrap external memory (rows x cols of `type`, `step` bytes per row, AUTO_STEP if packed) without copying.
+        // release(data) is called exactly once: when the pipeline is done with it, or at once if the push fails
+        bool push_external(void* data, int rows, int cols, int type, size_t step, cvedix_frame_release_callback release, int timeout_ms = 0) {
+            auto accepted = gate.is_open();
+            if (!accepted) {
+                CVEDIX_WARN(cvedix_utils::string_format("[%s] not started, frame is ignored", node_name.c_str()));
+            }
+            if (!accepted || !acquire_slot(timeout_ms)) {
+                if (release) {
+                    release(data);
+                }
+                return false;
+            }
+
+            cv::Mat frame(rows, cols, type, data, step);
+            auto u = new cv::UMatData(cvedix_external_frame_allocator::get());
+            u->data = u->origdata = static_cast<uchar*>(data);
+            u->size = frame.step[0] * rows;
+            u->refcount = 1;
+            u->userdata = new external_buffer{data, release, state};
+            frame.u = u;    // refcounted from now on, last release of any copy calls deallocate() above
+
+            {
+                std::lock_guard<std::mutex> guard(state->lock);
+                frames_to_handle.push_back({std::move(frame), true});
+            }
+            state->changed.notify_all();
+            return true;
+        }
+
+        // frames that can be pushed now without waiting
+        size_t free_capacity() const {
+            std::lock_guard<std::mutex> guard(state->lock);
+            return state->capacity - std::min(state->held, state->capacity);
+        }
+
+        size_t get_capacity() const {
+            return state->capacity;
+        }
+
+        // frames waiting for the node's thread
+        size_t queued() const {
+            std::lock_guard<std::mutex> guard(state->lock);
+            return frames_to_handle.size();
+        }
+    };
+}
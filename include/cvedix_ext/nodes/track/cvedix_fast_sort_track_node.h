@@ -0,0 +1,226 @@
+#pragma once
+
+#include "cvedix/nodes/cvedix_node.h"
+#include "cvedix/nodes/track/cvedix_track_node.h"
+#include "cvedix_ext/nodes/track/fast_sort/cvedix_fast_sort_tracker.h"
+#include "cvedix_ext/nodes/track/cvedix_track_lifecycle.h"
+#include "cvedix_ext/utils/cvedix_task_pool.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace cvedix_nodes {
+    // drop-in replacement of cvedix_sort_track_node for dense scenes (jam, crowd, 150+ objects per frame).
+    // association uses grid gating + greedy sparse assignment instead of full IoU matrix + Hungarian, see
+    // cvedix_fast_sort_tracker. output is the same as the SDK node: track_id and tracks (history of rects) are
+    // written into targets (or face_targets if track_for is FACE), unconfirmed detections keep track_id -1.
+    // each channel has its own tracker, so one node can serve multiple channels.
+    // with config.byte_track enabled the detector can run at a low score threshold: low-score detections only keep
+    // existing tracks alive and are removed from meta if they match none.
+    //
+    // track lifecycle (ENTER/EXIT with age and last seen) is produced natively for frames with changes, consume it by
+    // set_track_lifecycle_hooker(...) or look it up from downstream by get_track_lifecycle(channel, frame_index)
+    // instead of diffing track ids of consecutive frames.
+    //
+    // tracker state is sharded by channel. with shard_threads > 0 the node handles metas in batches of `batch_size`,
+    // groups them by channel and updates different channels in parallel on a small pool (frames of one channel are
+    // still tracked in arriving order, and metas leave the node in arriving order). batch_size is usually the
+    // number of channels attached. lifecycle hooker is called on pool threads then.
+    class cvedix_fast_sort_track_node: public cvedix_node {
+    private:
+        cvedix_track_for track_for;
+        cvedix_fast_sort_config config;
+        int max_track_length;
+
+        // everything one channel needs, shards are only touched by one thread at a time
+        struct channel_shard {
+            cvedix_fast_sort_tracker tracker;
+            // track id -> history rects
+            std::map<int, std::vector<cvedix_objects::cvedix_rect>> all_tracks;
+            // cached buffers
+            std::vector<cvedix_fast_sort_box> boxes;
+            std::vector<int> track_ids;
+            std::vector<int> target_indexes;
+
+            channel_shard(const cvedix_fast_sort_config& config): tracker(config) {}
+        };
+        // channel -> shard, only modified on node's thread
+        std::map<int, std::unique_ptr<channel_shard>> shards;
+        std::unique_ptr<cvedix_utils::cvedix_task_pool> shard_pool;
+
+        cvedix_track_lifecycle_queue lifecycle_queue;
+        cvedix_track_lifecycle_hooker lifecycle_hooker;
+
+        channel_shard& shard_of(int channel_index) {
+            auto& shard = shards[channel_index];
+            if (!shard) {
+                shard = std::make_unique<channel_shard>(config);
+            }
+            return *shard;
+        }
+
+        void track_frame(channel_shard& shard, const std::shared_ptr<cvedix_objects::cvedix_frame_meta>& meta) {
+            if (track_for == cvedix_track_for::FACE) {
+                track(shard, meta->channel_index, meta->frame_index, meta->face_targets);
+            }
+            else {
+                track(shard, meta->channel_index, meta->frame_index, meta->targets);
+            }
+        }
+
+        // normal targets and face targets name their confidence differently
+        static float score_of(const cvedix_objects::cvedix_frame_target& target) {
+            return target.primary_score;
+        }
+        static float score_of(const cvedix_objects::cvedix_frame_face_target& target) {
+            return target.score;
+        }
+
+        template<typename target_t>
+        void track(channel_shard& shard, int channel_index, int frame_index, std::vector<std::shared_ptr<target_t>>& targets) {
+            auto& boxes = shard.boxes;
+            auto& track_ids = shard.track_ids;
+            auto& target_indexes = shard.target_indexes;
+            boxes.resize(targets.size());
+            for (size_t i = 0; i < targets.size(); i++) {
+                auto& t = targets[i];
+                boxes[i] = {static_cast<float>(t->x), static_cast<float>(t->y),
+                            static_cast<float>(t->width), static_cast<float>(t->height), score_of(*t)};
+            }
+
+            auto& tracker = shard.tracker;
+            tracker.update(boxes, track_ids, frame_index);
+
+            auto& channel_tracks = shard.all_tracks;
+            for (auto id: tracker.last_removed_ids()) {
+                channel_tracks.erase(id);
+            }
+            for (size_t i = 0; i < targets.size(); i++) {
+                auto& t = targets[i];
+                t->track_id = track_ids[i];
+                if (track_ids[i] < 0) {
+                    continue;
+                }
+                auto& history = channel_tracks[track_ids[i]];
+                history.push_back(cvedix_objects::cvedix_rect(t->x, t->y, t->width, t->height));
+                if (history.size() > static_cast<size_t>(max_track_length)) {
+                    history.erase(history.begin());
+                }
+                t->tracks = history;
+            }
+
+            // byte_track mode: low-score detections which extend no track are background, remove them so that
+            // downstream nodes see the same targets as with a high detector threshold
+            auto& discarded = tracker.last_discarded();
+            target_indexes.resize(targets.size());
+            int kept = 0;
+            for (size_t i = 0; i < targets.size(); i++) {
+                target_indexes[i] = discarded[i] ? -1 : kept;
+                if (!discarded[i]) {
+                    targets[kept++] = targets[i];
+                }
+            }
+            targets.resize(kept);
+
+            publish_lifecycle(tracker, target_indexes, channel_index, frame_index);
+        }
+
+        void publish_lifecycle(const cvedix_fast_sort_tracker& tracker, const std::vector<int>& target_indexes,
+                               int channel_index, int frame_index) {
+            auto& entered = tracker.last_entered();
+            auto& exited = tracker.last_exited();
+            if (entered.empty() && exited.empty()) {
+                return;
+            }
+
+            auto lifecycle = std::make_shared<cvedix_track_lifecycle>();
+            lifecycle->channel_index = channel_index;
+            lifecycle->frame_index = frame_index;
+            lifecycle->active_tracks = tracker.track_count();
+            lifecycle->events.reserve(entered.size() + exited.size());
+            auto add = [&](cvedix_track_event_type type, const cvedix_fast_sort_track_change& change) {
+                cvedix_track_event e;
+                e.type = type;
+                e.track_id = change.track_id;
+                e.target_index = change.detection_index >= 0 ? target_indexes[change.detection_index] : -1;
+                e.first_seen = change.first_seen;
+                e.last_seen = change.last_seen;
+                e.age = frame_index - change.first_seen;
+                e.hits = change.hits;
+                lifecycle->events.push_back(e);
+            };
+            for (auto& c: entered) {
+                add(cvedix_track_event_type::ENTER, c);
+            }
+            for (auto& c: exited) {
+                add(cvedix_track_event_type::EXIT, c);
+            }
+
+            lifecycle_queue.push(lifecycle);
+            if (lifecycle_hooker) {
+                lifecycle_hooker(node_name, *lifecycle);
+            }
+        }
+
+    protected:
+        virtual std::shared_ptr<cvedix_objects::cvedix_meta> handle_frame_meta(std::shared_ptr<cvedix_objects::cvedix_frame_meta> meta) override {
+            track_frame(shard_of(meta->channel_index), meta);
+            return meta;
+        }
+
+        // batch_size > 1, metas are pushed to next nodes by base class in the same order after return
+        virtual void handle_frame_meta(const std::vector<std::shared_ptr<cvedix_objects::cvedix_frame_meta>>& meta_with_batch) override {
+            // group by channel, keep arriving order inside each group
+            std::vector<std::pair<channel_shard*, std::vector<std::shared_ptr<cvedix_objects::cvedix_frame_meta>>>> groups;
+            for (auto& meta: meta_with_batch) {
+                auto shard = &shard_of(meta->channel_index);
+                auto it = std::find_if(groups.begin(), groups.end(), [&](const auto& g) { return g.first == shard; });
+                if (it == groups.end()) {
+                    groups.push_back({shard, {}});
+                    it = groups.end() - 1;
+                }
+                it->second.push_back(meta);
+            }
+
+            shard_pool->parallel_for(groups.size(), [&](int i) {
+                for (auto& meta: groups[i].second) {
+                    track_frame(*groups[i].first, meta);
+                }
+            });
+        }
+
+    public:
+        cvedix_fast_sort_track_node(std::string node_name,
+                                    cvedix_track_for track_for = cvedix_track_for::NORMAL,
+                                    cvedix_fast_sort_config config = cvedix_fast_sort_config(),
+                                    int max_track_length = 50,
+                                    int lifecycle_cache_frames = 256,
+                                    int shard_threads = 0,
+                                    int batch_size = 1):
+                                    cvedix_node(node_name),
+                                    track_for(track_for),
+                                    config(config),
+                                    max_track_length(max_track_length),
+                                    lifecycle_queue(lifecycle_cache_frames) {
+            // the caller's thread takes part in parallel_for, so n threads means n + 1 channels at the same time
+            shard_pool = std::make_unique<cvedix_utils::cvedix_task_pool>(shard_threads);
+            if (shard_threads > 0) {
+                this->frame_meta_handle_batch = std::max(1, batch_size);
+            }
+            this->initialized();
+        }
+        ~cvedix_fast_sort_track_node() = default;
+
+        // set before pipeline starts
+        void set_track_lifecycle_hooker(cvedix_track_lifecycle_hooker hooker) {
+            lifecycle_hooker = hooker;
+        }
+
+        // changes of a frame tracked recently, nullptr if nothing entered/exited in that frame. thread-safe.
+        std::shared_ptr<const cvedix_track_lifecycle> get_track_lifecycle(int channel_index, int frame_index) {
+            return lifecycle_queue.find(channel_index, frame_index);
+        }
+    };
+}
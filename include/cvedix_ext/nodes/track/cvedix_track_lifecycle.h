@@ -0,0 +1,78 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cvedix_nodes {
+    enum class cvedix_track_event_type {
+        ENTER,      // track id reported for the first time
+        EXIT        // track removed, its id will never be reported again
+    };
+
+    struct cvedix_track_event {
+        cvedix_track_event_type type;
+        int track_id = -1;
+        int target_index = -1;      // index in targets (or face_targets) of the frame meta for ENTER, -1 for EXIT
+        int first_seen = 0;         // frame index of the first detection of track
+        int last_seen = 0;          // frame index of the last matched detection of track
+        int age = 0;                // frames from first_seen to the frame of this event
+        int hits = 0;               // matched detections in total
+    };
+
+    // track changes of one frame, only created for frames with at least one change
+    struct cvedix_track_lifecycle {
+        int channel_index = -1;
+        int frame_index = -1;
+        int active_tracks = 0;      // tracks alive in tracker after this frame (including unconfirmed)
+        std::vector<cvedix_track_event> events;
+    };
+
+    // called on tracker's thread right after a frame with changes is tracked
+    typedef std::function<void(std::string, const cvedix_track_lifecycle&)> cvedix_track_lifecycle_hooker;
+
+    // lifecycle of recent frames, for downstream nodes (brokers, ba nodes) running on other threads.
+    // they look up changes of the frame they are handling by (channel_index, frame_index), nullptr means no change.
+    // only the latest `capacity` frames with changes are kept per channel, a consumer lagging further behind the
+    // tracker misses events (use the hooker instead if that is not acceptable).
+    class cvedix_track_lifecycle_queue {
+    private:
+        int capacity;
+        std::map<int, std::deque<std::shared_ptr<const cvedix_track_lifecycle>>> channels;
+        std::mutex channels_lock;
+
+    public:
+        cvedix_track_lifecycle_queue(int capacity = 256): capacity(capacity) {}
+
+        void push(std::shared_ptr<const cvedix_track_lifecycle> lifecycle) {
+            std::lock_guard<std::mutex> guard(channels_lock);
+            auto& q = channels[lifecycle->channel_index];
+            q.push_back(lifecycle);
+            while (q.size() > static_cast<size_t>(capacity)) {
+                q.pop_front();
+            }
+        }
+
+        std::shared_ptr<const cvedix_track_lifecycle> find(int channel_index, int frame_index) {
+            std::lock_guard<std::mutex> guard(channels_lock);
+            auto it = channels.find(channel_index);
+            if (it == channels.end()) {
+                return nullptr;
+            }
+            // frames arrive in order, search from the newest one
+            for (auto i = it->second.rbegin(); i != it->second.rend(); i++) {
+                if ((*i)->frame_index == frame_index) {
+                    return *i;
+                }
+                if ((*i)->frame_index < frame_index) {
+                    break;
+                }
+            }
+            return nullptr;
+        }
+    };
+}
@@ -0,0 +1,470 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace cvedix_nodes {
+    // detection/track box in pixels, (x, y) is the top-left corner
+    struct cvedix_fast_sort_box {
+        float x = 0;
+        float y = 0;
+        float width = 0;
+        float height = 0;
+        float score = 1;
+    };
+
+    // a track which became visible (first reported id) or disappeared (removed after being reported)
+    struct cvedix_fast_sort_track_change {
+        int track_id = -1;
+        int detection_index = -1;   // index in detections of the update for entered tracks, -1 for exited tracks
+        int first_seen = 0;         // frame index of the detection which started the track
+        int last_seen = 0;          // frame index of the last matched detection
+        int hits = 0;               // matched detections in total
+    };
+
+    struct cvedix_fast_sort_config {
+        int max_age = 3;                // frames a track survives without any matched detection
+        int min_hits = 3;               // matched frames in a row before a track id is reported
+        float iou_threshold = 0.3;      // minimum IoU for a detection/track pair to be associated
+        float grid_cell_size = 0;       // cell size of spatial gating grid in pixels, 0 means 2x average box size
+
+        // ByteTrack-style two-stage association.
+        // detections >= high_score_threshold are associated first and are the only ones allowed to start tracks,
+        // then detections in [low_score_threshold, high_score_threshold) are used to extend tracks still unmatched
+        // (tracks matched in previous frame only). low detections which extend nothing are treated as background.
+        // lets detector run with a low threshold without creating tracks from low-confidence noise.
+        bool byte_track = false;
+        float high_score_threshold = 0.6;
+        float low_score_threshold = 0.1;
+        float low_iou_threshold = 0.5;  // IoU threshold of second stage, stricter since low detections are noisy
+    };
+
+    // SORT tracker for dense scenes without Hungarian algorithm.
+    // 1. kalman state of all tracks is kept in structure-of-arrays form, predict/update are plain loops over
+    //    contiguous floats the compiler can vectorize. the constant-velocity model is decoupled per axis
+    //    (center x, center y, area with velocity, aspect ratio as random walk), so each axis has a 2x2 covariance.
+    // 2. predicted track boxes are bucketed into a uniform grid, a detection only computes IoU with tracks in the
+    //    cells it overlaps, so candidate pairs grow with local density instead of tracks x detections.
+    // 3. candidate pairs above the IoU threshold form a sparse cost list solved greedily (best IoU first), which
+    //    is what Hungarian converges to in practice once gating removed ambiguous far pairs.
+    // one instance tracks one channel and is not thread-safe.
+    class cvedix_fast_sort_tracker {
+    private:
+        cvedix_fast_sort_config config;
+        int frame_count = 0;
+        int current_frame = 0;      // frame index of current update
+        int next_id = 0;
+
+        // kalman state, SoA
+        std::vector<float> cx, cy, area, ratio;         // position part
+        std::vector<float> vx, vy, varea;               // velocity part
+        std::vector<float> pxx, pxv, pvv_x;             // covariance of (cx, vx)
+        std::vector<float> pyy, pyv, pvv_y;             // covariance of (cy, vy)
+        std::vector<float> pss, psv, pvv_s;             // covariance of (area, varea)
+        std::vector<float> prr;                         // variance of ratio
+        // bookkeeping, SoA
+        std::vector<int> ids;
+        std::vector<int> hits;
+        std::vector<int> hit_streak;
+        std::vector<int> time_since_update;
+        std::vector<float> last_score;
+        std::vector<char> reported;                     // id has been reported at least once
+        std::vector<int> first_seen, last_seen;
+
+        // predicted boxes of current frame
+        std::vector<cvedix_fast_sort_box> predicted;
+        // ids removed by last update
+        std::vector<int> removed_ids;
+        // lifecycle changes of last update
+        std::vector<cvedix_fast_sort_track_change> entered, exited;
+        // detections of last update treated as background (byte_track only)
+        std::vector<char> discarded;
+
+        // gating grid in CSR form: cell -> [cell_start[cell], cell_start[cell + 1]) in cell_tracks
+        float grid_x0 = 0, grid_y0 = 0, cell_size = 1;
+        int grid_w = 0, grid_h = 0;
+        std::vector<int> cell_start;
+        std::vector<int> cell_tracks;
+        std::vector<int> visit_stamp;
+
+        struct candidate {
+            float iou;
+            int track;
+            int detection;
+        };
+        std::vector<candidate> candidates;
+
+        // process noise and measurement noise, same magnitudes as reference SORT
+        static constexpr float q_pos = 1.0f, q_vel = 0.01f, q_area_vel = 0.0001f;
+        static constexpr float r_pos = 1.0f, r_area = 10.0f, r_ratio = 10.0f;
+
+        static float iou(const cvedix_fast_sort_box& a, const cvedix_fast_sort_box& b) {
+            auto w = std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x);
+            auto h = std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y);
+            if (w <= 0 || h <= 0) {
+                return 0;
+            }
+            auto inter = w * h;
+            return inter / (a.width * a.height + b.width * b.height - inter);
+        }
+
+        // 2x2 constant-velocity predict for one axis on arrays, vectorizable
+        static void predict_axis(float* __restrict pos, float* __restrict vel,
+                                 float* __restrict p00, float* __restrict p01, float* __restrict p11,
+                                 float q0, float q1, int n) {
+            for (int i = 0; i < n; i++) {
+                pos[i] += vel[i];
+                p00[i] += 2 * p01[i] + p11[i] + q0;
+                p01[i] += p11[i];
+                p11[i] += q1;
+            }
+        }
+
+        static void update_axis(float& pos, float& vel, float& p00, float& p01, float& p11, float z, float r) {
+            auto s = p00 + r;
+            auto k0 = p00 / s;
+            auto k1 = p01 / s;
+            auto y = z - pos;
+            pos += k0 * y;
+            vel += k1 * y;
+            p11 -= k1 * p01;
+            p01 *= (1 - k0);
+            p00 *= (1 - k0);
+        }
+
+        static cvedix_fast_sort_box to_box(float cx, float cy, float area, float ratio) {
+            cvedix_fast_sort_box box;
+            area = std::max(area, 1.0f);
+            ratio = std::max(ratio, 1e-3f);
+            box.width = std::sqrt(area * ratio);
+            box.height = area / box.width;
+            box.x = cx - box.width / 2;
+            box.y = cy - box.height / 2;
+            return box;
+        }
+
+        void add_track(const cvedix_fast_sort_box& det) {
+            cx.push_back(det.x + det.width / 2);
+            cy.push_back(det.y + det.height / 2);
+            area.push_back(det.width * det.height);
+            ratio.push_back(det.width / std::max(det.height, 1e-3f));
+            vx.push_back(0);
+            vy.push_back(0);
+            varea.push_back(0);
+            // high uncertainty for unobserved velocities, as reference SORT
+            pxx.push_back(10); pxv.push_back(0); pvv_x.push_back(1e4f);
+            pyy.push_back(10); pyv.push_back(0); pvv_y.push_back(1e4f);
+            pss.push_back(10); psv.push_back(0); pvv_s.push_back(1e4f);
+            prr.push_back(10);
+            ids.push_back(next_id++);
+            hits.push_back(1);
+            hit_streak.push_back(1);
+            time_since_update.push_back(0);
+            last_score.push_back(det.score);
+            reported.push_back(0);
+            first_seen.push_back(current_frame);
+            last_seen.push_back(current_frame);
+            predicted.push_back(det);
+        }
+
+        // swap-remove track i, O(1)
+        void remove_track(int i) {
+            auto last = static_cast<int>(ids.size()) - 1;
+            auto move = [&](auto& v) { v[i] = v[last]; v.pop_back(); };
+            move(cx); move(cy); move(area); move(ratio); move(vx); move(vy); move(varea);
+            move(pxx); move(pxv); move(pvv_x); move(pyy); move(pyv); move(pvv_y);
+            move(pss); move(psv); move(pvv_s); move(prr);
+            move(ids); move(hits); move(hit_streak); move(time_since_update); move(last_score);
+            move(reported); move(first_seen); move(last_seen);
+            move(predicted);
+        }
+
+        void predict() {
+            auto n = static_cast<int>(ids.size());
+            // area must not become negative
+            for (int i = 0; i < n; i++) {
+                if (area[i] + varea[i] <= 0) {
+                    varea[i] = 0;
+                }
+            }
+            predict_axis(cx.data(), vx.data(), pxx.data(), pxv.data(), pvv_x.data(), q_pos, q_vel, n);
+            predict_axis(cy.data(), vy.data(), pyy.data(), pyv.data(), pvv_y.data(), q_pos, q_vel, n);
+            predict_axis(area.data(), varea.data(), pss.data(), psv.data(), pvv_s.data(), q_pos, q_area_vel, n);
+            for (int i = 0; i < n; i++) {
+                prr[i] += q_pos;
+            }
+
+            predicted.resize(n);
+            for (int i = 0; i < n; i++) {
+                predicted[i] = to_box(cx[i], cy[i], area[i], ratio[i]);
+                if (time_since_update[i] > 0) {
+                    hit_streak[i] = 0;
+                }
+                time_since_update[i]++;
+            }
+        }
+
+        void correct(int i, const cvedix_fast_sort_box& det) {
+            update_axis(cx[i], vx[i], pxx[i], pxv[i], pvv_x[i], det.x + det.width / 2, r_pos);
+            update_axis(cy[i], vy[i], pyy[i], pyv[i], pvv_y[i], det.y + det.height / 2, r_pos);
+            update_axis(area[i], varea[i], pss[i], psv[i], pvv_s[i], det.width * det.height, r_area);
+            auto k = prr[i] / (prr[i] + r_ratio);
+            ratio[i] += k * (det.width / std::max(det.height, 1e-3f) - ratio[i]);
+            prr[i] *= (1 - k);
+
+            time_since_update[i] = 0;
+            hits[i]++;
+            hit_streak[i]++;
+            last_score[i] = det.score;
+            last_seen[i] = current_frame;
+        }
+
+        // bucket predicted boxes of `tracks` into the grid
+        void build_grid(const std::vector<int>& tracks, const std::vector<cvedix_fast_sort_box>& detections) {
+            grid_w = grid_h = 0;
+            cell_start.clear();
+            cell_tracks.clear();
+            if (tracks.empty()) {
+                return;
+            }
+
+            float x0 = predicted[tracks[0]].x, y0 = predicted[tracks[0]].y, x1 = x0, y1 = y0;
+            double size_sum = 0;
+            for (auto t: tracks) {
+                auto& b = predicted[t];
+                x0 = std::min(x0, b.x);
+                y0 = std::min(y0, b.y);
+                x1 = std::max(x1, b.x + b.width);
+                y1 = std::max(y1, b.y + b.height);
+                size_sum += b.width + b.height;
+            }
+            for (auto& d: detections) {
+                size_sum += d.width + d.height;
+            }
+
+            // 2x average box side by default, never more cells than ~4 per track
+            cell_size = config.grid_cell_size > 0 ? config.grid_cell_size
+                                                  : static_cast<float>(size_sum / (tracks.size() + detections.size()));
+            cell_size = std::max(cell_size, 1.0f);
+            auto max_cells = 4.0f * tracks.size() + 64;
+            while ((x1 - x0) / cell_size * (y1 - y0) / cell_size > max_cells) {
+                cell_size *= 2;
+            }
+            grid_x0 = x0;
+            grid_y0 = y0;
+            grid_w = static_cast<int>((x1 - x0) / cell_size) + 1;
+            grid_h = static_cast<int>((y1 - y0) / cell_size) + 1;
+
+            // counting sort into CSR
+            cell_start.assign(grid_w * grid_h + 1, 0);
+            auto for_cells = [&](const cvedix_fast_sort_box& b, auto&& func) {
+                auto cx0 = std::max(0, static_cast<int>((b.x - grid_x0) / cell_size));
+                auto cy0 = std::max(0, static_cast<int>((b.y - grid_y0) / cell_size));
+                auto cx1 = std::min(grid_w - 1, static_cast<int>((b.x + b.width - grid_x0) / cell_size));
+                auto cy1 = std::min(grid_h - 1, static_cast<int>((b.y + b.height - grid_y0) / cell_size));
+                for (int gy = cy0; gy <= cy1; gy++) {
+                    for (int gx = cx0; gx <= cx1; gx++) {
+                        func(gy * grid_w + gx);
+                    }
+                }
+            };
+            for (auto t: tracks) {
+                for_cells(predicted[t], [&](int cell) { cell_start[cell + 1]++; });
+            }
+            for (int c = 0; c < grid_w * grid_h; c++) {
+                cell_start[c + 1] += cell_start[c];
+            }
+            cell_tracks.resize(cell_start.back());
+            std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+            for (auto t: tracks) {
+                for_cells(predicted[t], [&](int cell) { cell_tracks[fill[cell]++] = t; });
+            }
+        }
+
+        // gated IoU between `dets` (indexes into detections) and tracks in grid, then greedy sparse assignment.
+        // matched[d] receives track index for detection d, unmatched detections/tracks are left untouched.
+        void associate(const std::vector<cvedix_fast_sort_box>& detections, const std::vector<int>& dets,
+                       const std::vector<int>& tracks, float iou_threshold,
+                       std::vector<int>& det_to_track, std::vector<char>& track_matched) {
+            if (dets.empty() || tracks.empty()) {
+                return;
+            }
+            build_grid(tracks, detections);
+
+            candidates.clear();
+            visit_stamp.assign(ids.size(), -1);
+            for (auto d: dets) {
+                auto& b = detections[d];
+                auto cx0 = std::max(0, static_cast<int>((b.x - grid_x0) / cell_size));
+                auto cy0 = std::max(0, static_cast<int>((b.y - grid_y0) / cell_size));
+                auto cx1 = std::min(grid_w - 1, static_cast<int>((b.x + b.width - grid_x0) / cell_size));
+                auto cy1 = std::min(grid_h - 1, static_cast<int>((b.y + b.height - grid_y0) / cell_size));
+                for (int gy = cy0; gy <= cy1; gy++) {
+                    for (int gx = cx0; gx <= cx1; gx++) {
+                        auto cell = gy * grid_w + gx;
+                        for (int k = cell_start[cell]; k < cell_start[cell + 1]; k++) {
+                            auto t = cell_tracks[k];
+                            if (visit_stamp[t] == d) {
+                                continue;   // track spans several cells, test once per detection
+                            }
+                            visit_stamp[t] = d;
+                            auto v = iou(b, predicted[t]);
+                            if (v >= iou_threshold) {
+                                candidates.push_back({v, t, d});
+                            }
+                        }
+                    }
+                }
+            }
+
+            std::sort(candidates.begin(), candidates.end(), [](const candidate& a, const candidate& b) { return a.iou > b.iou; });
+            for (auto& c: candidates) {
+                if (det_to_track[c.detection] >= 0 || track_matched[c.track]) {
+                    continue;
+                }
+                det_to_track[c.detection] = c.track;
+                track_matched[c.track] = 1;
+            }
+        }
+
+        cvedix_fast_sort_track_change change_of(int t, int detection_index) const {
+            cvedix_fast_sort_track_change change;
+            change.track_id = ids[t];
+            change.detection_index = detection_index;
+            change.first_seen = first_seen[t];
+            change.last_seen = last_seen[t];
+            change.hits = hits[t];
+            return change;
+        }
+
+        void report(int t, int detection_index) {
+            if (!reported[t]) {
+                reported[t] = 1;
+                entered.push_back(change_of(t, detection_index));
+            }
+        }
+
+    public:
+        explicit cvedix_fast_sort_tracker(const cvedix_fast_sort_config& config = cvedix_fast_sort_config()): config(config) {}
+
+        // track one frame. track_ids[i] receives the id for detections[i], -1 if its track is not confirmed yet
+        // (or detections[i] is discarded as background, see last_discarded()).
+        // frame_index is only used for first_seen/last_seen of lifecycle changes, internal counter if < 0.
+        void update(const std::vector<cvedix_fast_sort_box>& detections, std::vector<int>& track_ids, int frame_index = -1) {
+            frame_count++;
+            current_frame = frame_index >= 0 ? frame_index : frame_count;
+            removed_ids.clear();
+            entered.clear();
+            exited.clear();
+            predict();
+
+            auto n_dets = static_cast<int>(detections.size());
+            auto n_tracks = static_cast<int>(ids.size());
+            std::vector<int> det_to_track(n_dets, -1);
+            std::vector<char> track_matched(n_tracks, 0);
+            discarded.assign(n_dets, 0);
+
+            // split detections by score, all of them are high ones if byte_track disabled
+            std::vector<int> high_dets, low_dets;
+            for (int d = 0; d < n_dets; d++) {
+                if (!config.byte_track || detections[d].score >= config.high_score_threshold) {
+                    high_dets.push_back(d);
+                }
+                else if (detections[d].score >= config.low_score_threshold) {
+                    low_dets.push_back(d);
+                }
+                else {
+                    discarded[d] = 1;
+                }
+            }
+
+            // stage 1, high detections against all tracks
+            std::vector<int> all_tracks(n_tracks);
+            for (int t = 0; t < n_tracks; t++) {
+                all_tracks[t] = t;
+            }
+            associate(detections, high_dets, all_tracks, config.iou_threshold, det_to_track, track_matched);
+
+            // stage 2, low detections against tracks which were alive in previous frame but got nothing in stage 1
+            if (!low_dets.empty()) {
+                std::vector<int> remaining_tracks;
+                for (int t = 0; t < n_tracks; t++) {
+                    if (!track_matched[t] && time_since_update[t] == 1) {
+                        remaining_tracks.push_back(t);
+                    }
+                }
+                associate(detections, low_dets, remaining_tracks, config.low_iou_threshold, det_to_track, track_matched);
+                for (auto d: low_dets) {
+                    if (det_to_track[d] < 0) {
+                        discarded[d] = 1;
+                    }
+                }
+            }
+
+            for (int d = 0; d < n_dets; d++) {
+                if (det_to_track[d] >= 0) {
+                    correct(det_to_track[d], detections[d]);
+                }
+            }
+
+            // ids are read before removal since swap-remove moves tracks around
+            track_ids.assign(n_dets, -1);
+            for (int d = 0; d < n_dets; d++) {
+                auto t = det_to_track[d];
+                if (t >= 0 && (hit_streak[t] >= config.min_hits || frame_count <= config.min_hits)) {
+                    track_ids[d] = ids[t];
+                    report(t, d);
+                }
+            }
+
+            // remove dead tracks (before adding new ones, indexes of new tracks stay valid)
+            for (int t = n_tracks - 1; t >= 0; t--) {
+                if (time_since_update[t] > config.max_age) {
+                    removed_ids.push_back(ids[t]);
+                    if (reported[t]) {
+                        exited.push_back(change_of(t, -1));
+                    }
+                    remove_track(t);
+                }
+            }
+
+            // only high detections start new tracks
+            for (auto d: high_dets) {
+                if (det_to_track[d] < 0) {
+                    add_track(detections[d]);
+                    if (frame_count <= config.min_hits) {
+                        track_ids[d] = ids.back();
+                        report(ids.size() - 1, d);
+                    }
+                }
+            }
+        }
+
+        // flag per detection of last update, 1 means it was dropped as background (below low_score_threshold,
+        // or a low detection which extended no track). always 0 if byte_track disabled.
+        const std::vector<char>& last_discarded() const {
+            return discarded;
+        }
+
+        // ids of tracks removed in the last update (exceeded max_age)
+        const std::vector<int>& last_removed_ids() const {
+            return removed_ids;
+        }
+
+        // tracks reported for the first time in last update, O(changes)
+        const std::vector<cvedix_fast_sort_track_change>& last_entered() const {
+            return entered;
+        }
+
+        // reported tracks removed in last update (not matched for more than max_age frames)
+        const std::vector<cvedix_fast_sort_track_change>& last_exited() const {
+            return exited;
+        }
+
+        int track_count() const {
+            return ids.size();
+        }
+    };
+}
@@ -0,0 +1,314 @@
+#pragma once
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cvedix_utils {
+    // when written data is forced to storage
+    enum class cvedix_sync_policy {
+        NONE,       // leave it to the kernel (page cache), fastest, data of last seconds lost on power cut
+        BATCH,      // one syncfs(...) after each batch of writes, cost of a flush shared by the whole batch
+        EACH        // fdatasync(...) every file before it is reported complete
+    };
+
+    // what to do when the queue is full (storage slower than producers)
+    enum class cvedix_overflow_policy {
+        DROP,       // reject new write, submit(...) returns false, pipeline never waits for disk
+        BLOCK       // wait for room in queue, backpressure to the caller
+    };
+
+    struct cvedix_async_file_writer_config {
+        size_t max_queue_items = 64;
+        size_t max_queue_bytes = 64 * 1024 * 1024;  // data passed in, or size hint of producers (memory they hold)
+        size_t max_batch_items = 16;                // writes taken per round of the I/O thread
+        cvedix_sync_policy sync_policy = cvedix_sync_policy::NONE;
+        cvedix_overflow_policy overflow_policy = cvedix_overflow_policy::DROP;
+        bool direct_io = false;                     // O_DIRECT (bypass page cache), falls back to buffered I/O if refused
+    };
+
+    // called on I/O thread when a write is done (or failed)
+    typedef std::function<void(const std::string& path, bool ok)> cvedix_write_complete_callback;
+
+    // writes files on a dedicated I/O thread, so slow storage (SD cards, fsync stalls of hundreds of ms) never blocks
+    // pipeline threads. submissions go to a bounded queue, the I/O thread takes them in batches:
+    //   - appends to the same file within a batch are coalesced into one writev(...).
+    //   - data can be produced on the I/O thread (e.g. jpeg encoding) by submitting a producer instead of bytes.
+    //   - sync policy decides how often data is forced to storage, BATCH pays one flush per batch.
+    //
+    // usage:
+    // cvedix_async_file_writer writer;
+    // writer.submit("./images/1.jpg", [img]() { std::vector<uint8_t> buf; cv::imencode(".jpg", img, buf); return buf; },
+    //               img.total() * img.elemSize(), [](const std::string& path, bool ok) { ... });
+    class cvedix_async_file_writer {
+    private:
+        struct request {
+            std::string path;
+            bool append = false;
+            std::vector<uint8_t> data;
+            std::function<std::vector<uint8_t>()> producer;
+            cvedix_write_complete_callback callback;
+            size_t bytes = 0;   // counted against max_queue_bytes while queued
+        };
+
+        cvedix_async_file_writer_config config;
+        std::deque<request> queue;
+        size_t queue_bytes = 0;
+        std::mutex queue_lock;
+        std::condition_variable queue_changed;
+        bool stop = false;
+        std::thread io_thread;
+
+        std::atomic<uint64_t> written {0};
+        std::atomic<uint64_t> failed {0};
+        std::atomic<uint64_t> dropped {0};
+
+        static bool write_all(int fd, const std::vector<const std::vector<uint8_t>*>& parts) {
+            std::vector<iovec> iov;
+            for (auto p: parts) {
+                if (!p->empty()) {
+                    iov.push_back({const_cast<uint8_t*>(p->data()), p->size()});
+                }
+            }
+            size_t first = 0;
+            while (first < iov.size()) {
+                auto n = writev(fd, iov.data() + first, std::min<size_t>(iov.size() - first, IOV_MAX));
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                // skip fully written buffers, advance into a partially written one
+                while (first < iov.size() && static_cast<size_t>(n) >= iov[first].iov_len) {
+                    n -= iov[first].iov_len;
+                    first++;
+                }
+                if (first < iov.size()) {
+                    iov[first].iov_base = static_cast<uint8_t*>(iov[first].iov_base) + n;
+                    iov[first].iov_len -= n;
+                }
+            }
+            return true;
+        }
+
+        // O_DIRECT needs aligned buffer, offset and length: write padded to block size, then cut the file to size
+        static bool write_direct(const std::string& path, const std::vector<const std::vector<uint8_t>*>& parts) {
+            const size_t block = 4096;
+            size_t size = 0;
+            for (auto p: parts) size += p->size();
+            auto padded = (size + block - 1) / block * block;
+            void* buffer = nullptr;
+            if (padded == 0 || posix_memalign(&buffer, block, padded) != 0) {
+                return false;
+            }
+            auto out = static_cast<uint8_t*>(buffer);
+            for (auto p: parts) {
+                std::memcpy(out, p->data(), p->size());
+                out += p->size();
+            }
+            std::memset(out, 0, padded - size);
+
+            bool ok = false;
+            auto fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+            if (fd >= 0) {
+                size_t done = 0;
+                ok = true;
+                while (done < padded) {
+                    auto n = write(fd, static_cast<uint8_t*>(buffer) + done, padded - done);
+                    if (n < 0 && errno == EINTR) continue;
+                    if (n <= 0) { ok = false; break; }
+                    done += n;
+                }
+                ok = ok && ftruncate(fd, size) == 0;
+                close(fd);
+            }
+            free(buffer);
+            return ok;
+        }
+
+        // write one file from one or more parts, return fd kept open for sync (or -1)
+        bool write_file(const std::string& path, bool append, const std::vector<const std::vector<uint8_t>*>& parts, int& sync_fd) {
+            sync_fd = -1;
+            if (config.direct_io && !append && write_direct(path, parts)) {
+                if (config.sync_policy != cvedix_sync_policy::NONE) {
+                    sync_fd = open(path.c_str(), O_WRONLY);
+                }
+                return true;
+            }
+            auto fd = open(path.c_str(), O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC), 0644);
+            if (fd < 0) {
+                return false;
+            }
+            auto ok = write_all(fd, parts);
+            if (ok && config.sync_policy != cvedix_sync_policy::NONE) {
+                sync_fd = fd;   // closed after sync
+            }
+            else {
+                close(fd);
+            }
+            return ok;
+        }
+
+        void process(std::vector<request>& batch) {
+            // produce data outside of queue lock (encoding etc.)
+            for (auto& r: batch) {
+                if (r.producer) {
+                    r.data = r.producer();
+                    r.producer = nullptr;
+                }
+            }
+
+            // requests of a batch in order, consecutive appends to the same file become one writev
+            std::vector<std::pair<size_t, bool>> results;   // index of request, ok
+            std::vector<int> sync_fds;
+            for (size_t i = 0; i < batch.size();) {
+                std::vector<const std::vector<uint8_t>*> parts {&batch[i].data};
+                auto j = i + 1;
+                while (batch[i].append && j < batch.size() && batch[j].append && batch[j].path == batch[i].path) {
+                    parts.push_back(&batch[j].data);
+                    j++;
+                }
+                int fd = -1;
+                auto ok = write_file(batch[i].path, batch[i].append, parts, fd);
+                if (ok && fd >= 0) {
+                    if (config.sync_policy == cvedix_sync_policy::EACH) {
+                        ok = fdatasync(fd) == 0;
+                        close(fd);
+                    }
+                    else {
+                        sync_fds.push_back(fd);
+                    }
+                }
+                for (auto k = i; k < j; k++) {
+                    results.push_back({k, ok});
+                }
+                i = j;
+            }
+            if (!sync_fds.empty()) {
+                // one flush of the filesystem for everything in this batch (BATCH), if it fails no write of the
+                // batch is known to be on storage
+                auto synced = syncfs(sync_fds.front()) == 0;
+                for (auto fd: sync_fds) close(fd);
+                if (!synced) {
+                    for (auto& result: results) {
+                        result.second = false;
+                    }
+                }
+            }
+
+            for (auto& [index, ok]: results) {
+                (ok ? written : failed)++;
+                if (batch[index].callback) {
+                    batch[index].callback(batch[index].path, ok);
+                }
+            }
+        }
+
+        void run() {
+            std::vector<request> batch;
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> guard(queue_lock);
+                    queue_changed.wait(guard, [this]() { return stop || !queue.empty(); });
+                    if (queue.empty()) {
+                        return;     // stopped and drained
+                    }
+                    batch.clear();
+                    while (!queue.empty() && batch.size() < config.max_batch_items) {
+                        queue_bytes -= queue.front().bytes;
+                        batch.push_back(std::move(queue.front()));
+                        queue.pop_front();
+                    }
+                }
+                queue_changed.notify_all();     // room for blocked producers
+                process(batch);
+            }
+        }
+
+        bool enqueue(request&& r) {
+            std::unique_lock<std::mutex> guard(queue_lock);
+            auto full = [&]() {
+                return queue.size() >= config.max_queue_items ||
+                       (!queue.empty() && queue_bytes + r.bytes > config.max_queue_bytes);
+            };
+            if (full()) {
+                if (config.overflow_policy == cvedix_overflow_policy::DROP || stop) {
+                    dropped++;
+                    return false;
+                }
+                queue_changed.wait(guard, [&]() { return stop || !full(); });
+                if (stop) {
+                    dropped++;
+                    return false;
+                }
+            }
+            queue_bytes += r.bytes;
+            queue.push_back(std::move(r));
+            queue_changed.notify_all();
+            return true;
+        }
+
+    public:
+        cvedix_async_file_writer(const cvedix_async_file_writer_config& config = cvedix_async_file_writer_config()):
+                                 config(config) {
+            this->config.max_queue_items = std::max<size_t>(1, this->config.max_queue_items);
+            this->config.max_batch_items = std::max<size_t>(1, this->config.max_batch_items);
+            io_thread = std::thread(&cvedix_async_file_writer::run, this);
+        }
+        // writes already queued are finished before returning
+        ~cvedix_async_file_writer() {
+            {
+                std::lock_guard<std::mutex> guard(queue_lock);
+                stop = true;
+            }
+            queue_changed.notify_all();
+            if (io_thread.joinable()) {
+                io_thread.join();
+            }
+        }
+        cvedix_async_file_writer(const cvedix_async_file_writer&) = delete;
+        cvedix_async_file_writer& operator=(const cvedix_async_file_writer&) = delete;
+
+        // write (replace) file with data, false if dropped because queue is full
+        bool submit(const std::string& path, std::vector<uint8_t> data, cvedix_write_complete_callback callback = nullptr) {
+            auto bytes = data.size();
+            return enqueue({path, false, std::move(data), nullptr, callback, bytes});
+        }
+
+        // write (replace) file with data produced on I/O thread.
+        // size_hint: memory held by the producer until it runs (e.g. image.total() * image.elemSize() of a captured
+        // cv::Mat), counted against max_queue_bytes like data
+        bool submit(const std::string& path, std::function<std::vector<uint8_t>()> producer, size_t size_hint, cvedix_write_complete_callback callback = nullptr) {
+            return enqueue({path, false, {}, producer, callback, size_hint});
+        }
+
+        // append data to file (created if not exists)
+        bool append(const std::string& path, std::vector<uint8_t> data, cvedix_write_complete_callback callback = nullptr) {
+            auto bytes = data.size();
+            return enqueue({path, true, std::move(data), nullptr, callback, bytes});
+        }
+
+        size_t pending() {
+            std::lock_guard<std::mutex> guard(queue_lock);
+            return queue.size();
+        }
+
+        uint64_t written_count() const { return written; }
+        uint64_t failed_count() const { return failed; }
+        uint64_t dropped_count() const { return dropped; }
+    };
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace cvedix_utils {
+    // bounded multi-producer/multi-consumer queue used to hand work between threads.
+    // push blocks while queue is full (capacity <= 0 means unbounded), pop blocks while queue is empty.
+    // close() wakes up all waiters, then push fails immediately and pop drains the remaining items.
+    template<typename T>
+    class cvedix_blocking_queue {
+    private:
+        std::deque<T> items;
+        int capacity;
+        bool closed = false;
+        std::mutex lock;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+
+        bool full() const {
+            return capacity > 0 && items.size() >= static_cast<size_t>(capacity);
+        }
+
+    public:
+        explicit cvedix_blocking_queue(int capacity = 0): capacity(capacity) {}
+
+        // wait until space available, return false if queue closed
+        bool push(T item) {
+            std::unique_lock<std::mutex> guard(lock);
+            not_full.wait(guard, [this] { return closed || !full(); });
+            if (closed) {
+                return false;
+            }
+            items.push_back(std::move(item));
+            not_empty.notify_one();
+            return true;
+        }
+
+        // wait at most timeout_ms (< 0 means forever), return false on timeout or closed
+        bool push_for(T item, int timeout_ms) {
+            if (timeout_ms < 0) {
+                return push(std::move(item));
+            }
+            std::unique_lock<std::mutex> guard(lock);
+            if (!not_full.wait_for(guard, std::chrono::milliseconds(timeout_ms), [this] { return closed || !full(); }) || closed) {
+                return false;
+            }
+            items.push_back(std::move(item));
+            not_empty.notify_one();
+            return true;
+        }
+
+        // never wait, return false if full or closed
+        bool try_push(T item) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (closed || full()) {
+                return false;
+            }
+            items.push_back(std::move(item));
+            not_empty.notify_one();
+            return true;
+        }
+
+        // wait until item available, return false if queue closed and drained
+        bool pop(T& item) {
+            std::unique_lock<std::mutex> guard(lock);
+            not_empty.wait(guard, [this] { return closed || !items.empty(); });
+            if (items.empty()) {
+                return false;
+            }
+            item = std::move(items.front());
+            items.pop_front();
+            not_full.notify_one();
+            return true;
+        }
+
+        // wait at most timeout_ms (< 0 means forever), return false on timeout or closed and drained
+        bool pop_for(T& item, int timeout_ms) {
+            if (timeout_ms < 0) {
+                return pop(item);
+            }
+            std::unique_lock<std::mutex> guard(lock);
+            not_empty.wait_for(guard, std::chrono::milliseconds(timeout_ms), [this] { return closed || !items.empty(); });
+            if (items.empty()) {
+                return false;
+            }
+            item = std::move(items.front());
+            items.pop_front();
+            not_full.notify_one();
+            return true;
+        }
+
+        bool try_pop(T& item) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (items.empty()) {
+                return false;
+            }
+            item = std::move(items.front());
+            items.pop_front();
+            not_full.notify_one();
+            return true;
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> guard(lock);
+            closed = true;
+            not_empty.notify_all();
+            not_full.notify_all();
+        }
+
+        bool is_closed() {
+            std::lock_guard<std::mutex> guard(lock);
+            return closed;
+        }
+
+        int size() {
+            std::lock_guard<std::mutex> guard(lock);
+            return items.size();
+        }
+
+        int get_capacity() const {
+            return capacity;
+        }
+    };
+}
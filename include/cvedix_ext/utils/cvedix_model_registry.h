@@ -0,0 +1,207 @@
+#pragma once
+
+#include <opencv2/dnn.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace cvedix_utils {
+    // identity of a loaded network, nodes with equal keys share the same weights in memory
+    struct cvedix_model_key {
+        std::string model_path;
+        std::string model_config_path;
+        int backend = cv::dnn::DNN_BACKEND_DEFAULT;
+        int target = cv::dnn::DNN_TARGET_CPU;
+        std::string options;    // anything else which makes networks incompatible (precision, device id, ...)
+
+        bool operator<(const cvedix_model_key& other) const {
+            return std::tie(model_path, model_config_path, backend, target, options) <
+                   std::tie(other.model_path, other.model_config_path, other.backend, other.target, other.options);
+        }
+
+        std::string to_string() const {
+            return model_path + (model_config_path.empty() ? "" : "|" + model_config_path) +
+                   "|" + std::to_string(backend) + "|" + std::to_string(target) + (options.empty() ? "" : "|" + options);
+        }
+    };
+
+    // one network shared by many nodes.
+    // cv::dnn::Net is not thread-safe for forward, so it is split into inference contexts: each context is an
+    // independent cv::dnn::Net and only one node uses it at a time (see lease). the first context is created at
+    // load time, more contexts (up to max_contexts) come from nets donated by later users (donate(...)) or are loaded
+    // lazily when all existing ones are busy.
+    // sharing saves resident memory (weights, runtime buffers), not load time: every net is still parsed once.
+    class cvedix_shared_model {
+    private:
+        struct context {
+            cv::dnn::Net net;
+            bool busy = false;
+        };
+
+        cvedix_model_key key;
+        std::function<cv::dnn::Net()> loader;
+        int max_contexts;
+        std::vector<std::unique_ptr<context>> contexts;
+        std::mutex contexts_lock;
+        std::condition_variable context_released;
+
+        context* acquire_context() {
+            std::unique_lock<std::mutex> guard(contexts_lock);
+            while (true) {
+                for (auto& c: contexts) {
+                    if (!c->busy) {
+                        c->busy = true;
+                        return c.get();
+                    }
+                }
+                if (contexts.size() < static_cast<size_t>(max_contexts) && loader) {
+                    contexts.push_back(std::make_unique<context>());
+                    auto c = contexts.back().get();
+                    c->busy = true;
+                    guard.unlock();
+                    try {
+                        c->net = loader();  // load outside of lock, other contexts stay usable
+                    }
+                    catch (...) {
+                        // give the slot back, a waiter may load it again or use a released context
+                        guard.lock();
+                        contexts.erase(std::find_if(contexts.begin(), contexts.end(), [c](const std::unique_ptr<context>& p) { return p.get() == c; }));
+                        context_released.notify_one();
+                        throw;
+                    }
+                    return c;
+                }
+                context_released.wait(guard);
+            }
+        }
+
+        void release_context(context* c) {
+            std::lock_guard<std::mutex> guard(contexts_lock);
+            c->busy = false;
+            context_released.notify_one();
+        }
+
+    public:
+        // exclusive use of one inference context, released when lease destroyed
+        class lease {
+        private:
+            cvedix_shared_model* model;
+            context* ctx;
+        public:
+            lease(cvedix_shared_model* model): model(model), ctx(model->acquire_context()) {}
+            ~lease() {
+                model->release_context(ctx);
+            }
+            lease(const lease&) = delete;
+            lease& operator=(const lease&) = delete;
+
+            cv::dnn::Net& net() {
+                return ctx->net;
+            }
+        };
+
+        // `preloaded` (if not empty) becomes the first context, otherwise `loader` is called immediately
+        cvedix_shared_model(const cvedix_model_key& key, std::function<cv::dnn::Net()> loader, int max_contexts, cv::dnn::Net preloaded):
+                            key(key), loader(loader), max_contexts(std::max(1, max_contexts)) {
+            contexts.push_back(std::make_unique<context>());
+            contexts.back()->net = preloaded.empty() ? loader() : preloaded;
+        }
+
+        // add an already loaded net as another context, false (net not kept) if max_contexts is reached
+        bool donate(cv::dnn::Net net) {
+            std::lock_guard<std::mutex> guard(contexts_lock);
+            if (net.empty() || contexts.size() >= static_cast<size_t>(max_contexts)) {
+                return false;
+            }
+            contexts.push_back(std::make_unique<context>());
+            contexts.back()->net = net;
+            context_released.notify_one();
+            return true;
+        }
+
+        const cvedix_model_key& get_key() const {
+            return key;
+        }
+
+        int context_count() {
+            std::lock_guard<std::mutex> guard(contexts_lock);
+            return contexts.size();
+        }
+    };
+
+    // process-wide registry of shared networks keyed by cvedix_model_key.
+    // registry only holds weak references, a network is unloaded when the last node using it is destroyed.
+    //
+    // usage:
+    // auto model = cvedix_model_registry::get().acquire(key, [&]() { return cv::dnn::readNet(key.model_path); });
+    // cvedix_shared_model::lease ctx(model.get());
+    // ctx.net().setInput(blob); ctx.net().forward(outputs);
+    class cvedix_model_registry {
+    private:
+        std::map<cvedix_model_key, std::weak_ptr<cvedix_shared_model>> models;
+        std::mutex models_lock;
+        cvedix_model_registry() = default;
+
+    public:
+        static cvedix_model_registry& get() {
+            static cvedix_model_registry registry;
+            return registry;
+        }
+        cvedix_model_registry(const cvedix_model_registry&) = delete;
+        cvedix_model_registry& operator=(const cvedix_model_registry&) = delete;
+
+        // return the shared network for key, load it (or adopt `preloaded`) if not exists yet.
+        // `created` (optional) tells whether this call created it (and adopted `preloaded`)
+        std::shared_ptr<cvedix_shared_model> acquire(const cvedix_model_key& key,
+                                                     std::function<cv::dnn::Net()> loader,
+                                                     int max_contexts = 1,
+                                                     cv::dnn::Net preloaded = cv::dnn::Net(),
+                                                     bool* created = nullptr) {
+            std::lock_guard<std::mutex> guard(models_lock);
+            auto it = models.find(key);
+            if (it != models.end()) {
+                if (auto model = it->second.lock()) {
+                    if (created) *created = false;
+                    return model;
+                }
+            }
+            auto model = std::make_shared<cvedix_shared_model>(key, loader, max_contexts, preloaded);
+            models[key] = model;
+            if (created) *created = true;
+            return model;
+        }
+
+        // loader for cvedix_model_key using cv::dnn::readNet(...) with backend and target applied
+        static std::function<cv::dnn::Net()> default_loader(const cvedix_model_key& key) {
+            return [key]() {
+                auto net = cv::dnn::readNet(key.model_path, key.model_config_path);
+                net.setPreferableBackend(key.backend);
+                net.setPreferableTarget(key.target);
+                return net;
+            };
+        }
+
+        // alive models with number of users and contexts, for logging
+        std::string to_string() {
+            std::lock_guard<std::mutex> guard(models_lock);
+            std::stringstream ss;
+            for (auto& [key, weak_model]: models) {
+                auto users = weak_model.use_count();
+                if (users == 0) {
+                    continue;
+                }
+                auto model = weak_model.lock();
+                ss << "[" << key.to_string() << "] users:" << users << " contexts:" << (model ? model->context_count() : 0) << "\n";
+            }
+            return ss.str();
+        }
+    };
+}
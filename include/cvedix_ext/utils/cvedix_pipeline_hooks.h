@@ -0,0 +1,125 @@
+#pragma once
+
+#include "cvedix/nodes/cvedix_node.h"
+#include "cvedix/nodes/des/cvedix_des_node.h"
+#include "cvedix/nodes/src/cvedix_src_node.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace cvedix_utils {
+    enum class cvedix_pipeline_node_kind {
+        SRC,
+        MID,
+        DES
+    };
+
+    struct cvedix_pipeline_node {
+        int index;                  // position in cvedix_pipeline_hooks::get_nodes()
+        std::string name;
+        cvedix_pipeline_node_kind kind;
+        cvedix_nodes::cvedix_node* node;
+    };
+
+    // receives meta hooker events of every node of a pipeline. called on pipeline threads, keep it short:
+    // arriving:  meta pushed into the node's in queue (upstream node's thread), queue_size after push
+    // handling:  meta popped by the node's thread, about to be handled
+    // handled:   node produced a meta (node's thread), after handling or generated by src nodes
+    // leaving:   meta sent to next nodes
+    // handled and leaving are not always on the node's own thread: nodes handing metas on from a worker thread
+    // (e.g. the postprocess thread of cvedix_pipelined_infer_node, via pendding_meta) call them there, concurrently
+    // with arriving/handling of later metas. state shared between events of one node needs its own synchronization.
+    class cvedix_pipeline_listener {
+    public:
+        virtual ~cvedix_pipeline_listener() = default;
+        // once when added, before any event
+        virtual void on_attached(const std::vector<cvedix_pipeline_node>&) {}
+        virtual void on_meta_arriving(const cvedix_pipeline_node&, int, const std::shared_ptr<cvedix_objects::cvedix_meta>&) {}
+        virtual void on_meta_handling(const cvedix_pipeline_node&, int, const std::shared_ptr<cvedix_objects::cvedix_meta>&) {}
+        virtual void on_meta_handled(const cvedix_pipeline_node&, int, const std::shared_ptr<cvedix_objects::cvedix_meta>&) {}
+        virtual void on_meta_leaving(const cvedix_pipeline_node&, int, const std::shared_ptr<cvedix_objects::cvedix_meta>&) {}
+    };
+
+    // every node has a single slot per meta hooker, so only one tool could observe a pipeline at a time.
+    // cvedix_pipeline_hooks takes the 4 hookers of every node reachable from the src nodes (next_nodes(), like
+    // cvedix_analysis_board) and fans events out to any number of listeners (metrics, tracer, ...).
+    // do not use together with cvedix_analysis_board on the same pipeline, the last one to set hookers wins.
+    // listeners are added before pipeline starts, hookers are cleared on destruction.
+    //
+    // usage:
+    // auto hooks = std::make_shared<cvedix_utils::cvedix_pipeline_hooks>(std::vector<std::shared_ptr<cvedix_nodes::cvedix_node>>{src_0});
+    // hooks->add_listener(metrics);
+    // src_0->start();
+    class cvedix_pipeline_hooks {
+    private:
+        std::vector<std::shared_ptr<cvedix_nodes::cvedix_node>> nodes;
+        std::vector<cvedix_pipeline_node> infos;
+        std::vector<std::shared_ptr<cvedix_pipeline_listener>> listeners;
+
+        void collect(const std::vector<std::shared_ptr<cvedix_nodes::cvedix_node>>& from, std::set<cvedix_nodes::cvedix_node*>& visited) {
+            for (auto& node: from) {
+                if (!visited.insert(node.get()).second) {
+                    continue;
+                }
+                auto kind = std::dynamic_pointer_cast<cvedix_nodes::cvedix_src_node>(node) ? cvedix_pipeline_node_kind::SRC :
+                            std::dynamic_pointer_cast<cvedix_nodes::cvedix_des_node>(node) ? cvedix_pipeline_node_kind::DES :
+                            cvedix_pipeline_node_kind::MID;
+                infos.push_back({static_cast<int>(nodes.size()), node->node_name, kind, node.get()});
+                nodes.push_back(node);
+                collect(node->next_nodes(), visited);
+            }
+        }
+
+    public:
+        cvedix_pipeline_hooks(std::vector<std::shared_ptr<cvedix_nodes::cvedix_node>> src_nodes) {
+            std::set<cvedix_nodes::cvedix_node*> visited;
+            collect(src_nodes, visited);
+
+            for (size_t i = 0; i < nodes.size(); i++) {
+                auto info = &infos[i];
+                nodes[i]->set_meta_arriving_hooker([this, info](std::string, int queue_size, std::shared_ptr<cvedix_objects::cvedix_meta> meta) {
+                    for (auto& l: listeners) {
+                        l->on_meta_arriving(*info, queue_size, meta);
+                    }
+                });
+                nodes[i]->set_meta_handling_hooker([this, info](std::string, int queue_size, std::shared_ptr<cvedix_objects::cvedix_meta> meta) {
+                    for (auto& l: listeners) {
+                        l->on_meta_handling(*info, queue_size, meta);
+                    }
+                });
+                nodes[i]->set_meta_handled_hooker([this, info](std::string, int queue_size, std::shared_ptr<cvedix_objects::cvedix_meta> meta) {
+                    for (auto& l: listeners) {
+                        l->on_meta_handled(*info, queue_size, meta);
+                    }
+                });
+                nodes[i]->set_meta_leaving_hooker([this, info](std::string, int queue_size, std::shared_ptr<cvedix_objects::cvedix_meta> meta) {
+                    for (auto& l: listeners) {
+                        l->on_meta_leaving(*info, queue_size, meta);
+                    }
+                });
+            }
+        }
+        ~cvedix_pipeline_hooks() {
+            for (auto& node: nodes) {
+                node->set_meta_arriving_hooker(nullptr);
+                node->set_meta_handling_hooker(nullptr);
+                node->set_meta_handled_hooker(nullptr);
+                node->set_meta_leaving_hooker(nullptr);
+            }
+        }
+        cvedix_pipeline_hooks(const cvedix_pipeline_hooks&) = delete;
+        cvedix_pipeline_hooks& operator=(const cvedix_pipeline_hooks&) = delete;
+
+        // set before pipeline starts
+        void add_listener(std::shared_ptr<cvedix_pipeline_listener> listener) {
+            listener->on_attached(infos);
+            listeners.push_back(listener);
+        }
+
+        const std::vector<cvedix_pipeline_node>& get_nodes() const {
+            return infos;
+        }
+    };
+}
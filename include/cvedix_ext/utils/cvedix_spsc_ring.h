@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace cvedix_utils {
+    // bounded lock-free queue for exactly one producer thread and one consumer thread.
+    // capacity is rounded up to a power of 2, push/pop are wait-free (one acquire load + one release store),
+    // head and tail live on separate cache lines so producer and consumer do not invalidate each other.
+    template<typename T>
+    class cvedix_spsc_ring {
+    private:
+        std::unique_ptr<T[]> slots;
+        size_t mask;
+        alignas(64) std::atomic<size_t> head {0};   // next slot to pop, written by consumer
+        alignas(64) std::atomic<size_t> tail {0};   // next slot to push, written by producer
+
+        static size_t round_up(size_t n) {
+            size_t c = 2;
+            while (c < n) c <<= 1;
+            return c;
+        }
+
+    public:
+        explicit cvedix_spsc_ring(size_t capacity): slots(new T[round_up(capacity)]), mask(round_up(capacity) - 1) {}
+
+        // producer only, false if full
+        bool try_push(T&& value) {
+            auto t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) > mask) {
+                return false;
+            }
+            slots[t & mask] = std::move(value);
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer only, false if empty
+        bool try_pop(T& value) {
+            auto h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            value = std::move(slots[h & mask]);
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        // approximate when called from a third thread
+        size_t size() const {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+        size_t capacity() const {
+            return mask + 1;
+        }
+    };
+}
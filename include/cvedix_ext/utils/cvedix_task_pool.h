@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cvedix_utils {
+    // small fixed-size thread pool for fork-join work inside one node.
+    // parallel_for(n, func) calls func(0..n-1) on the pool threads plus the caller's thread and returns when all calls
+    // are finished, so a node can split one meta batch into independent parts without changing its output order.
+    // the first exception thrown by func is rethrown on the caller's thread.
+    //
+    // usage:
+    // cvedix_task_pool pool(2);
+    // pool.parallel_for(channels.size(), [&](int i) { process(channels[i]); });
+    class cvedix_task_pool {
+    private:
+        std::vector<std::thread> workers;
+        std::mutex job_lock;
+        std::condition_variable job_arrived;
+        std::condition_variable job_done;
+        std::mutex call_lock;       // one parallel_for at a time
+
+        const std::function<void(int)>* job = nullptr;
+        int job_size = 0;
+        std::atomic<int> next_item {0};
+        int active_workers = 0;
+        uint64_t generation = 0;
+        bool stop = false;
+        std::exception_ptr error;
+
+        void run_items(const std::function<void(int)>& func, int n) {
+            int i;
+            while ((i = next_item.fetch_add(1)) < n) {
+                try {
+                    func(i);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> guard(job_lock);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        void worker_run() {
+            uint64_t seen = 0;
+            std::unique_lock<std::mutex> guard(job_lock);
+            while (true) {
+                job_arrived.wait(guard, [&]() { return stop || generation != seen; });
+                if (stop) {
+                    return;
+                }
+                seen = generation;
+                auto func = job;
+                auto n = job_size;
+                guard.unlock();
+                run_items(*func, n);
+                guard.lock();
+                if (--active_workers == 0) {
+                    job_done.notify_all();
+                }
+            }
+        }
+
+    public:
+        // threads == 0 means parallel_for runs everything on caller's thread
+        explicit cvedix_task_pool(int threads) {
+            for (int i = 0; i < threads; i++) {
+                workers.emplace_back(&cvedix_task_pool::worker_run, this);
+            }
+        }
+
+        ~cvedix_task_pool() {
+            {
+                std::lock_guard<std::mutex> guard(job_lock);
+                stop = true;
+            }
+            job_arrived.notify_all();
+            for (auto& w: workers) {
+                w.join();
+            }
+        }
+
+        cvedix_task_pool(const cvedix_task_pool&) = delete;
+        cvedix_task_pool& operator=(const cvedix_task_pool&) = delete;
+
+        void parallel_for(int n, const std::function<void(int)>& func) {
+            if (n <= 0) {
+                return;
+            }
+            if (workers.empty() || n == 1) {
+                for (int i = 0; i < n; i++) {
+                    func(i);
+                }
+                return;
+            }
+
+            std::lock_guard<std::mutex> call_guard(call_lock);
+            {
+                std::lock_guard<std::mutex> guard(job_lock);
+                job = &func;
+                job_size = n;
+                next_item = 0;
+                active_workers = workers.size();
+                error = nullptr;
+                generation++;
+            }
+            job_arrived.notify_all();
+            run_items(func, n);
+
+            std::unique_lock<std::mutex> guard(job_lock);
+            job_done.wait(guard, [&]() { return active_workers == 0; });
+            job = nullptr;
+            if (error) {
+                auto e = error;
+                error = nullptr;
+                std::rethrow_exception(e);
+            }
+        }
+
+        int thread_count() const {
+            return workers.size();
+        }
+    };
+}
@@ -0,0 +1,295 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/freetype.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cvedix_utils {
+    // rasterized text, coverage (0-255) of every pixel. all texts of one font height share the same rows
+    // (same baseline), so they can be placed side by side.
+    struct cvedix_text_image {
+        cv::Mat alpha;          // CV_8UC1
+        int font_height = 0;
+    };
+
+    // cache of rasterized text for one font (cv::freetype), shared by all osd nodes using the same font file.
+    // cv::freetype::FreeType2::putText shapes and rasterizes every glyph on each call, for CJK labels, plate strings
+    // and long text this dominates osd time. here:
+    //   1. glyphs are rasterized once per font height into a glyph atlas (coverage mask + advance).
+    //   2. strings are composed from atlas glyphs without calling freetype, and kept in a LRU cache keyed by
+    //      text and height, so labels repeating every frame cost one lookup.
+    //   3. drawing is a simd alpha blend of the coverage mask with any color (color is not part of the key, one
+    //      rasterization serves all colors), see blend_row(...).
+    // strings are laid out glyph by glyph using advances only (no kerning), which is how CJK and plate text is set
+    // anyway, latin labels may differ slightly from FreeType2::putText.
+    //
+    // usage:
+    // auto atlas = cvedix_text_atlas::acquire("./cvedix_data/font/NotoSansCJKsc-Medium.otf");
+    // atlas->put_text(frame, "京A12345", cv::Point(10, 10), 24, cv::Scalar(0, 255, 0));
+    class cvedix_text_atlas {
+    private:
+        struct glyph {
+            cv::Mat alpha;      // rows = band height of font height
+            int left = 0;       // x of alpha relative to pen position, may be negative
+            int advance = 0;
+        };
+        struct band {
+            int top = 0;        // rows of canvas kept for all glyphs of one font height
+            int rows = 0;
+        };
+        struct string_entry {
+            std::string key;
+            std::shared_ptr<const cvedix_text_image> image;
+        };
+
+        std::string font_path;
+        cv::Ptr<cv::freetype::FreeType2> ft2;
+        int max_strings;
+        int max_glyphs;
+        std::mutex cache_lock;
+
+        std::map<int, band> bands;                                       // font height -> band
+        std::unordered_map<uint64_t, glyph> glyphs;                      // (font height, code point) -> glyph
+        std::list<string_entry> lru;                                     // most recently used first
+        std::unordered_map<std::string, std::list<string_entry>::iterator> strings;
+
+        static uint64_t glyph_key(int font_height, uint32_t code_point) {
+            return (static_cast<uint64_t>(font_height) << 32) | code_point;
+        }
+
+        // decode utf-8, invalid bytes are returned one by one
+        static std::vector<std::pair<uint32_t, std::string>> split_utf8(const std::string& text) {
+            std::vector<std::pair<uint32_t, std::string>> chars;
+            for (size_t i = 0; i < text.size();) {
+                auto c = static_cast<uint8_t>(text[i]);
+                int len = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xe ? 3 : (c >> 3) == 0x1e ? 4 : 1;
+                if (i + len > text.size()) {
+                    len = 1;
+                }
+                uint32_t code_point = len == 1 ? c : c & (0x7f >> len);
+                for (int k = 1; k < len; k++) {
+                    code_point = (code_point << 6) | (static_cast<uint8_t>(text[i + k]) & 0x3f);
+                }
+                chars.push_back({code_point, text.substr(i, len)});
+                i += len;
+            }
+            return chars;
+        }
+
+        // glyphs are drawn on a canvas 2x font height tall with baseline at font height
+        int canvas_rows(int font_height) const {
+            return font_height * 2;
+        }
+
+        cv::Mat rasterize(const std::string& text, int font_height, int pad, int& width) {
+            int baseline = 0;
+            width = ft2->getTextSize(text, font_height, -1, &baseline).width;
+            cv::Mat canvas(canvas_rows(font_height), width + pad * 2, CV_8UC3, cv::Scalar::all(0));
+            ft2->putText(canvas, text, cv::Point(pad, font_height), font_height, cv::Scalar::all(255), -1, cv::LINE_AA, true);
+            cv::Mat alpha;
+            cv::extractChannel(canvas, alpha, 0);
+            return alpha;
+        }
+
+        // rows with ink of a few reference glyphs (caps, descenders, CJK), shared by every glyph of this height
+        const band& band_of(int font_height) {
+            auto it = bands.find(font_height);
+            if (it != bands.end()) {
+                return it->second;
+            }
+            int width = 0;
+            auto alpha = rasterize("Hgjy|国", font_height, font_height, width);
+            int top = alpha.rows, bottom = -1;
+            for (int r = 0; r < alpha.rows; r++) {
+                if (cv::countNonZero(alpha.row(r))) {
+                    top = std::min(top, r);
+                    bottom = r;
+                }
+            }
+            band b;
+            if (bottom < 0) {
+                b = {0, alpha.rows};
+            }
+            else {
+                // a little room for glyphs taller than the references
+                b.top = std::max(0, top - font_height / 8);
+                b.rows = std::min(alpha.rows, bottom + 1 + font_height / 8) - b.top;
+            }
+            return bands[font_height] = b;
+        }
+
+        const glyph& glyph_of(int font_height, uint32_t code_point, const std::string& utf8) {
+            auto key = glyph_key(font_height, code_point);
+            auto it = glyphs.find(key);
+            if (it != glyphs.end()) {
+                return it->second;
+            }
+            auto& b = band_of(font_height);
+            auto pad = font_height / 2;     // room for overhanging glyphs
+            glyph g;
+            int width = 0;
+            auto alpha = rasterize(utf8, font_height, pad, width);
+            g.alpha = alpha.rowRange(b.top, b.top + b.rows).clone();
+            g.left = -pad;
+            // whitespace has no ink, getTextSize(...) may report 0
+            g.advance = width > 0 ? width : font_height / 3;
+            return glyphs[key] = g;
+        }
+
+        std::shared_ptr<const cvedix_text_image> compose(const std::string& text, int font_height) {
+            auto chars = split_utf8(text);
+            if (glyphs.size() + chars.size() > static_cast<size_t>(max_glyphs)) {
+                glyphs.clear();     // rare (font heights x distinct chars), simply start over
+            }
+            auto& b = band_of(font_height);
+
+            std::vector<const glyph*> parts;
+            int pen = 0, min_x = 0, max_x = 0;
+            for (auto& [code_point, utf8]: chars) {
+                auto& g = glyph_of(font_height, code_point, utf8);
+                parts.push_back(&g);
+                min_x = std::min(min_x, pen + g.left);
+                max_x = std::max(max_x, pen + g.left + g.alpha.cols);
+                pen += g.advance;
+            }
+
+            auto image = std::make_shared<cvedix_text_image>();
+            image->font_height = font_height;
+            image->alpha = cv::Mat::zeros(b.rows, std::max(1, max_x - min_x), CV_8UC1);
+            pen = -min_x;
+            for (auto g: parts) {
+                // neighbours can overlap a little, keep max coverage
+                cv::Mat roi = image->alpha.colRange(pen + g->left, pen + g->left + g->alpha.cols);
+                cv::max(roi, g->alpha, roi);
+                pen += g->advance;
+            }
+            // drop empty columns on both sides so text starts where it is placed
+            int first = 0, last = image->alpha.cols - 1;
+            while (first < last && !cv::countNonZero(image->alpha.col(first))) first++;
+            while (last > first && !cv::countNonZero(image->alpha.col(last))) last--;
+            image->alpha = image->alpha.colRange(first, last + 1).clone();
+            return image;
+        }
+
+    public:
+        cvedix_text_atlas(const std::string& font_path, int max_strings = 1024, int max_glyphs = 8192):
+                          font_path(font_path), max_strings(std::max(1, max_strings)), max_glyphs(std::max(1, max_glyphs)) {
+            ft2 = cv::freetype::createFreeType2();
+            ft2->loadFontData(font_path, 0);
+        }
+
+        // process-wide atlas of a font file, shared by nodes while any of them is alive
+        static std::shared_ptr<cvedix_text_atlas> acquire(const std::string& font_path) {
+            static std::map<std::string, std::weak_ptr<cvedix_text_atlas>> atlases;
+            static std::mutex atlases_lock;
+            std::lock_guard<std::mutex> guard(atlases_lock);
+            auto& weak_atlas = atlases[font_path];
+            auto atlas = weak_atlas.lock();
+            if (!atlas) {
+                atlas = std::make_shared<cvedix_text_atlas>(font_path);
+                weak_atlas = atlas;
+            }
+            return atlas;
+        }
+
+        // rasterized text, from cache if drawn recently. thread-safe, returned image is immutable
+        std::shared_ptr<const cvedix_text_image> render(const std::string& text, int font_height) {
+            auto key = std::to_string(font_height) + '\x1f' + text;
+            std::lock_guard<std::mutex> guard(cache_lock);
+            auto it = strings.find(key);
+            if (it != strings.end()) {
+                lru.splice(lru.begin(), lru, it->second);
+                return it->second->image;
+            }
+            auto image = compose(text, font_height);
+            lru.push_front({key, image});
+            strings[key] = lru.begin();
+            if (lru.size() > static_cast<size_t>(max_strings)) {
+                strings.erase(lru.back().key);
+                lru.pop_back();
+            }
+            return image;
+        }
+
+        // size of text as put_text(...) draws it
+        cv::Size get_text_size(const std::string& text, int font_height) {
+            auto image = render(text, font_height);
+            return image->alpha.size();
+        }
+
+        // draw text on a CV_8UC3 image, `org` is top left of text, clipped at image borders
+        void put_text(cv::Mat& img, const std::string& text, cv::Point org, int font_height, const cv::Scalar& color) {
+            if (text.empty() || font_height <= 0) {
+                return;
+            }
+            blend(img, *render(text, font_height), org, color);
+        }
+
+        static void blend(cv::Mat& img, const cvedix_text_image& text, cv::Point org, const cv::Scalar& color) {
+            CV_Assert(img.type() == CV_8UC3);
+            auto area = cv::Rect(org, text.alpha.size()) & cv::Rect(0, 0, img.cols, img.rows);
+            if (area.empty()) {
+                return;
+            }
+            uint8_t bgr[3] = {cv::saturate_cast<uint8_t>(color[0]), cv::saturate_cast<uint8_t>(color[1]), cv::saturate_cast<uint8_t>(color[2])};
+            for (int r = 0; r < area.height; r++) {
+                auto dst = img.ptr<uint8_t>(area.y + r) + area.x * 3;
+                auto alpha = text.alpha.ptr<uint8_t>(area.y - org.y + r) + (area.x - org.x);
+                blend_row(dst, alpha, area.width, bgr);
+            }
+        }
+
+        // dst = (dst * (255 - a) + color * a) / 255 for one row of interleaved bgr pixels.
+        // opencv universal intrinsics at the baseline simd of the build (SSE2/AVX2/NEON), one vector of pixels per
+        // step: deinterleave b/g/r, blend in 16 bits, interleave back. scalar loop for the tail.
+        static void blend_row(uint8_t* dst, const uint8_t* alpha, int width, const uint8_t bgr[3]) {
+            int x = 0;
+#if CV_SIMD
+            const int lanes = cv::v_uint8::nlanes;
+            const cv::v_uint16 color[3] = {cv::vx_setall_u16(bgr[0]), cv::vx_setall_u16(bgr[1]), cv::vx_setall_u16(bgr[2])};
+            const cv::v_uint16 half = cv::vx_setall_u16(128);
+            const cv::v_uint8 full = cv::vx_setall_u8(255);
+            for (; x <= width - lanes; x += lanes) {
+                cv::v_uint8 a = cv::vx_load(alpha + x);
+                cv::v_uint16 a_lo, a_hi, ia_lo, ia_hi;
+                cv::v_expand(a, a_lo, a_hi);
+                cv::v_expand(full - a, ia_lo, ia_hi);
+
+                cv::v_uint8 channels[3];
+                cv::v_load_deinterleave(dst + x * 3, channels[0], channels[1], channels[2]);
+                for (int c = 0; c < 3; c++) {
+                    cv::v_uint16 lo, hi;
+                    cv::v_expand(channels[c], lo, hi);
+                    // at most 255 * 255 + 128, no overflow in 16 bits
+                    lo = lo * ia_lo + color[c] * a_lo + half;
+                    hi = hi * ia_hi + color[c] * a_hi + half;
+                    channels[c] = cv::v_pack((lo + (lo >> 8)) >> 8, (hi + (hi >> 8)) >> 8);
+                }
+                cv::v_store_interleave(dst + x * 3, channels[0], channels[1], channels[2]);
+            }
+            cv::vx_cleanup();
+#endif
+            for (; x < width; x++) {
+                uint32_t a = alpha[x];
+                for (int c = 0; c < 3; c++) {
+                    uint32_t v = dst[x * 3 + c] * (255 - a) + bgr[c] * a + 128;
+                    dst[x * 3 + c] = static_cast<uint8_t>((v + (v >> 8)) >> 8);    // exact v / 255 rounded
+                }
+            }
+        }
+
+        const std::string& get_font_path() const {
+            return font_path;
+        }
+    };
+}
@@ -0,0 +1,618 @@
+#pragma once
+
+#include "cvedix_ext/utils/cvedix_spsc_ring.h"
+#include "cvedix_ext/utils/logger/cvedix_deferred_format.h"
+#include "cvedix_ext/utils/logger/cvedix_log_rate_limit.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cvedix_utils {
+    // same order as cvedix_log_level of the sdk logger
+    enum class cvedix_async_log_level {
+        ERROR = 1,
+        WARN = 2,
+        INFO = 3,
+        DEBUG = 4
+    };
+
+    // what a logging thread does when its ring is full (writer thread or sinks slower than producers)
+    enum class cvedix_log_overflow_policy {
+        DROP,       // record is dropped and counted, writer logs "N records dropped" later. caller never waits
+        BLOCK       // caller yields until there is room, nothing is lost
+    };
+
+    struct cvedix_log_record {
+        cvedix_async_log_level level = cvedix_async_log_level::INFO;
+        int64_t timestamp = 0;      // nanoseconds since epoch (system clock)
+        int thread_index = 0;       // small stable id of the logging thread
+        const char* file = "";      // string literal (__FILE__)
+        int line = 0;
+        std::string message;
+        cvedix_deferred_format deferred;   // format + arguments, formatted into message on writer thread
+        uint64_t suppressed = 0;    // rate-limited call site: hits not logged before this one
+    };
+
+    // output of the writer thread, called with a whole batch (records and their formatted lines), never concurrently
+    class cvedix_log_sink {
+    public:
+        virtual ~cvedix_log_sink() = default;
+        virtual void write(const std::vector<cvedix_log_record>& records, const std::string& text) = 0;
+        virtual void flush() {}
+    };
+
+    class cvedix_console_log_sink: public cvedix_log_sink {
+    public:
+        virtual void write(const std::vector<cvedix_log_record>&, const std::string& text) override {
+            std::fwrite(text.data(), 1, text.size(), stdout);
+        }
+        virtual void flush() override {
+            std::fflush(stdout);
+        }
+    };
+
+    // one file per day in `log_dir`, named like the sdk logger (YYYY-MM-DD.log), one fwrite per batch
+    class cvedix_file_log_sink: public cvedix_log_sink {
+    private:
+        std::string log_dir;
+        std::string current_day;
+        FILE* file = nullptr;
+
+        void open_for(int64_t timestamp) {
+            auto seconds = static_cast<time_t>(timestamp / 1000000000);
+            tm local;
+            localtime_r(&seconds, &local);
+            char day[16];
+            std::strftime(day, sizeof(day), "%Y-%m-%d", &local);
+            if (file && current_day == day) {
+                return;
+            }
+            if (file) {
+                std::fclose(file);
+            }
+            current_day = day;
+            file = std::fopen((log_dir + "/" + current_day + ".log").c_str(), "a");
+        }
+
+    public:
+        cvedix_file_log_sink(const std::string& log_dir = "./log"): log_dir(log_dir) {
+            for (size_t pos = 1; pos != std::string::npos; pos = log_dir.find('/', pos + 1)) {
+                mkdir(log_dir.substr(0, pos).c_str(), 0755);
+            }
+            mkdir(log_dir.c_str(), 0755);
+        }
+        ~cvedix_file_log_sink() {
+            if (file) {
+                std::fclose(file);
+            }
+        }
+
+        virtual void write(const std::vector<cvedix_log_record>& records, const std::string& text) override {
+            open_for(records.back().timestamp);
+            if (file) {
+                std::fwrite(text.data(), 1, text.size(), file);
+            }
+        }
+        virtual void flush() override {
+            if (file) {
+                std::fflush(file);
+            }
+        }
+    };
+
+    // hand batches to anything else, e.g. one kafka produce call per batch instead of per record
+    class cvedix_callback_log_sink: public cvedix_log_sink {
+    private:
+        std::function<void(const std::vector<cvedix_log_record>&, const std::string&)> callback;
+    public:
+        cvedix_callback_log_sink(std::function<void(const std::vector<cvedix_log_record>&, const std::string&)> callback): callback(callback) {}
+        virtual void write(const std::vector<cvedix_log_record>& records, const std::string& text) override {
+            callback(records, text);
+        }
+    };
+
+    struct cvedix_async_logger_config {
+        size_t ring_capacity = 256;         // records per logging thread, allocated when the thread logs first.
+                                            // raise it for threads logging long bursts with DROP policy
+        size_t max_batch = 4096;            // records per batch of writer thread
+        cvedix_log_overflow_policy overflow_policy = cvedix_log_overflow_policy::DROP;
+    };
+
+    // asynchronous logging backend.
+    // every logging thread owns a lock-free single-producer ring (registered on its first log call), a single writer
+    // thread drains all rings, orders each batch by time, formats it once and hands it to the sinks (console, file,
+    // callback for kafka, ...). logging threads never touch I/O, the cost on the caller is moving the message into a
+    // ring slot. when all rings are empty the writer sleeps on a condition variable, the first record after that wakes
+    // it (the only time a logging thread takes a lock), so an idle logger costs no cpu.
+    // records of one thread keep their order, records of different threads are ordered by timestamp within a batch.
+    //
+    // usage:
+    // auto& logger = cvedix_async_logger::get();
+    // logger.add_sink(std::make_shared<cvedix_console_log_sink>());
+    // logger.add_sink(std::make_shared<cvedix_file_log_sink>("./log"));
+    // logger.start();
+    // CVEDIX_ASYNC_INFO(cvedix_utils::string_format("thread id: %s", id.c_str()));
+    // CVEDIX_ASYNC_DEBUGF("thread id: %s", id);     // formatted on writer thread, nothing built if DEBUG is disabled
+    class cvedix_async_logger {
+    private:
+        struct producer {
+            cvedix_spsc_ring<cvedix_log_record> ring;
+            std::atomic<uint64_t> dropped {0};
+            std::atomic<bool> closed {false};   // thread exited, remove when drained
+            int index;
+            producer(size_t capacity, int index): ring(capacity), index(index) {}
+        };
+
+        // closes the ring of a thread when the thread exits
+        struct producer_handle {
+            std::shared_ptr<producer> p;
+            ~producer_handle() {
+                if (p) {
+                    p->closed = true;
+                }
+            }
+        };
+
+        cvedix_async_logger_config config;
+        std::vector<std::shared_ptr<cvedix_log_sink>> sinks;
+        std::vector<std::shared_ptr<producer>> producers;
+        std::mutex producers_lock;
+        std::atomic<uint64_t> producers_version {0};
+        int next_index = 0;
+
+        std::atomic<int> level {static_cast<int>(cvedix_async_log_level::INFO)};
+        std::atomic<bool> running {false};
+        std::atomic<bool> stopping {false};
+        std::thread writer;
+        std::atomic<bool> writer_idle {false};  // writer is (about to be) waiting on `wake`
+        bool wake_requested = false;
+        std::mutex wake_lock;
+        std::condition_variable wake;
+        std::mutex sinks_lock;              // writer thread, and callers while logger is not running
+
+        std::atomic<uint64_t> written {0};
+        std::atomic<uint64_t> dropped {0};
+
+        cvedix_async_logger() = default;
+
+        bool push(cvedix_log_record&& r) {
+            r.timestamp = now();
+            if (!running || stopping) {
+                std::vector<cvedix_log_record> batch;
+                batch.push_back(std::move(r));
+                std::string text;
+                emit(batch, text);
+                return true;
+            }
+
+            auto p = this_thread_producer();
+            r.thread_index = p->index;
+            while (!p->ring.try_push(std::move(r))) {
+                if (config.overflow_policy == cvedix_log_overflow_policy::DROP || stopping) {
+                    p->dropped++;
+                    dropped++;
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+            // pairs with the fence in wait_for_records: either the writer sees this record or we see it idle
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (writer_idle.load(std::memory_order_relaxed)) {
+                notify_writer();
+            }
+            return true;
+        }
+
+        void notify_writer() {
+            {
+                std::lock_guard<std::mutex> guard(wake_lock);
+                wake_requested = true;
+            }
+            wake.notify_one();
+        }
+
+        // block writer until a record is pushed, stop is requested, or `until` (next sweep of rate-limited sites)
+        void wait_for_records(const std::vector<std::shared_ptr<producer>>& local, uint64_t local_version,
+                              std::chrono::steady_clock::time_point until) {
+            std::unique_lock<std::mutex> guard(wake_lock);
+            writer_idle = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            // records pushed before writer_idle was visible (their producers did not notify), or a new thread
+            auto pending = local_version != producers_version.load() ||
+                           std::any_of(local.begin(), local.end(), [](const std::shared_ptr<producer>& p) {
+                               return p->ring.size() > 0 || p->dropped.load() > 0;
+                           });
+            if (!pending) {
+                wake.wait_until(guard, until, [this]() { return wake_requested || stopping; });
+            }
+            wake_requested = false;
+            writer_idle = false;
+        }
+
+        producer* this_thread_producer() {
+            thread_local producer_handle handle;
+            if (!handle.p) {
+                std::lock_guard<std::mutex> guard(producers_lock);
+                handle.p = std::make_shared<producer>(config.ring_capacity, next_index++);
+                producers.push_back(handle.p);
+                producers_version++;
+            }
+            return handle.p.get();
+        }
+
+        static int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        static const char* level_name(cvedix_async_log_level l) {
+            switch (l) {
+            case cvedix_async_log_level::ERROR: return "Error";
+            case cvedix_async_log_level::WARN:  return "Warn ";
+            case cvedix_async_log_level::INFO:  return "Info ";
+            default:                            return "Debug";
+            }
+        }
+
+        static void format(const cvedix_log_record& r, std::string& out) {
+            auto seconds = static_cast<time_t>(r.timestamp / 1000000000);
+            tm local;
+            localtime_r(&seconds, &local);
+            char head[96];
+            auto n = std::strftime(head, sizeof(head), "[%Y-%m-%d %H:%M:%S", &local);
+            auto file = r.file;
+            for (auto p = r.file; *p; p++) {
+                if (*p == '/') file = p + 1;
+            }
+            n += std::snprintf(head + n, sizeof(head) - n, ".%03d][%s][T%d]", static_cast<int>(r.timestamp / 1000000 % 1000), level_name(r.level), r.thread_index);
+            out.append(head, std::min(n, sizeof(head) - 1));
+            if (r.line > 0) {
+                out += '[';
+                out += file;
+                out += ':';
+                out += std::to_string(r.line);
+                out += ']';
+            }
+            out += ' ';
+            out += r.message;
+            if (r.suppressed > 0) {
+                out += " (+";
+                out += std::to_string(r.suppressed);
+                out += " suppressed)";
+            }
+            out += '\n';
+        }
+
+        void emit(std::vector<cvedix_log_record>& batch, std::string& text) {
+            std::stable_sort(batch.begin(), batch.end(), [](const cvedix_log_record& a, const cvedix_log_record& b) {
+                return a.timestamp < b.timestamp;
+            });
+            text.clear();
+            for (auto& r: batch) {
+                if (!r.deferred.empty()) {
+                    r.deferred.format(r.message);
+                    r.deferred.reset();
+                }
+                format(r, text);
+            }
+            std::lock_guard<std::mutex> guard(sinks_lock);
+            for (auto& s: sinks) {
+                s->write(batch, text);
+                s->flush();
+            }
+            written += batch.size();
+        }
+
+        // summaries of rate-limited call sites whose flood stopped (or goes on for long), see cvedix_log_site
+        void sweep_sites(std::vector<cvedix_log_record>& batch, bool all) {
+            cvedix_log_site::sweep([&](const cvedix_log_site& site, uint64_t n) {
+                cvedix_log_record r;
+                r.level = static_cast<cvedix_async_log_level>(site.level);
+                r.timestamp = now();
+                r.file = site.file;
+                r.line = site.line;
+                r.message = "last message repeated " + std::to_string(n) + " times";
+                batch.push_back(std::move(r));
+            }, 1000, 10000, all);
+        }
+
+        void run() {
+            std::vector<std::shared_ptr<producer>> local;
+            uint64_t local_version = -1;
+            std::vector<cvedix_log_record> batch;
+            std::string text;
+            cvedix_log_record record;
+            auto last_sweep = std::chrono::steady_clock::now();
+            const auto sweep_interval = std::chrono::milliseconds(250);
+
+            while (true) {
+                if (local_version != producers_version.load()) {
+                    std::lock_guard<std::mutex> guard(producers_lock);
+                    local = producers;
+                    local_version = producers_version;
+                }
+
+                auto stop_requested = stopping.load();
+                batch.clear();
+                bool removable = false;
+                for (auto& p: local) {
+                    while (batch.size() < config.max_batch && p->ring.try_pop(record)) {
+                        batch.push_back(std::move(record));
+                    }
+                    if (auto n = p->dropped.exchange(0)) {
+                        cvedix_log_record r;
+                        r.level = cvedix_async_log_level::WARN;
+                        r.timestamp = now();
+                        r.thread_index = p->index;
+                        r.message = "[async logger] " + std::to_string(n) + " records dropped, ring full";
+                        batch.push_back(std::move(r));
+                    }
+                    removable |= p->closed && p->ring.size() == 0;
+                }
+                if (removable) {
+                    std::lock_guard<std::mutex> guard(producers_lock);
+                    producers.erase(std::remove_if(producers.begin(), producers.end(), [](const std::shared_ptr<producer>& p) {
+                        return p->closed && p->ring.size() == 0;
+                    }), producers.end());
+                    producers_version++;
+                }
+                if (std::chrono::steady_clock::now() - last_sweep >= sweep_interval) {
+                    last_sweep = std::chrono::steady_clock::now();
+                    sweep_sites(batch, false);
+                }
+
+                if (!batch.empty()) {
+                    emit(batch, text);
+                    continue;
+                }
+                // rings were empty after the stop request was seen, everything logged before stop() is written
+                if (stop_requested) {
+                    return;
+                }
+                wait_for_records(local, local_version, last_sweep + sweep_interval);
+            }
+        }
+
+    public:
+        static cvedix_async_logger& get() {
+            static cvedix_async_logger logger;
+            return logger;
+        }
+        cvedix_async_logger(const cvedix_async_logger&) = delete;
+        cvedix_async_logger& operator=(const cvedix_async_logger&) = delete;
+        ~cvedix_async_logger() {
+            stop();
+        }
+
+        // before start()
+        void add_sink(std::shared_ptr<cvedix_log_sink> sink) {
+            sinks.push_back(sink);
+        }
+
+        void start(const cvedix_async_logger_config& config = cvedix_async_logger_config()) {
+            if (running) {
+                return;
+            }
+            this->config = config;
+            if (sinks.empty()) {
+                sinks.push_back(std::make_shared<cvedix_console_log_sink>());
+            }
+            stopping = false;
+            running = true;
+            writer = std::thread(&cvedix_async_logger::run, this);
+        }
+
+        // write everything logged so far and stop writer thread, later records are written on caller's thread
+        void stop() {
+            if (!running) {
+                return;
+            }
+            stopping = true;
+            notify_writer();
+            if (writer.joinable()) {
+                writer.join();
+            }
+            running = false;
+            // records pushed while writer was exiting
+            std::vector<cvedix_log_record> batch;
+            std::string text;
+            cvedix_log_record record;
+            {
+                std::lock_guard<std::mutex> guard(producers_lock);
+                for (auto& p: producers) {
+                    while (p->ring.try_pop(record)) {
+                        batch.push_back(std::move(record));
+                    }
+                }
+            }
+            sweep_sites(batch, true);
+            if (!batch.empty()) {
+                emit(batch, text);
+            }
+        }
+
+        void set_level(cvedix_async_log_level l) {
+            level = static_cast<int>(l);
+        }
+
+        bool enabled(cvedix_async_log_level l) const {
+            return static_cast<int>(l) <= level.load(std::memory_order_relaxed);
+        }
+
+        // false if dropped (ring full with DROP policy, or level disabled).
+        // message is already formatted, prefer the macros which skip building it when level is disabled
+        bool log(cvedix_async_log_level l, const char* file, int line, std::string message) {
+            if (!enabled(l)) {
+                return false;
+            }
+            cvedix_log_record r;
+            r.level = l;
+            r.file = file;
+            r.line = line;
+            r.message = std::move(message);
+            return push(std::move(r));
+        }
+
+        // printf-style, arguments are captured and formatted on the writer thread (see cvedix_deferred_format).
+        // `fmt` MUST be a string literal
+        template<typename... args_t>
+        bool logf(cvedix_async_log_level l, const char* file, int line, const char* fmt, args_t&&... args) {
+            if (!enabled(l)) {
+                return false;
+            }
+            cvedix_log_record r;
+            r.level = l;
+            r.file = file;
+            r.line = line;
+            if (!r.deferred.capture(fmt, std::forward<args_t>(args)...)) {
+                r.message = cvedix_deferred_format::format_now(fmt, args...);   // too large to keep inline
+            }
+            return push(std::move(r));
+        }
+
+        // logged hit of a rate-limited call site, `repeated` hits were suppressed before it (rate-limited macros)
+        bool log(const cvedix_log_site& site, uint64_t repeated, std::string message) {
+            cvedix_log_record r;
+            r.level = static_cast<cvedix_async_log_level>(site.level);
+            r.file = site.file;
+            r.line = site.line;
+            r.message = std::move(message);
+            r.suppressed = repeated;
+            return push(std::move(r));
+        }
+
+        template<typename... args_t>
+        bool logf(const cvedix_log_site& site, uint64_t repeated, const char* fmt, args_t&&... args) {
+            cvedix_log_record r;
+            r.level = static_cast<cvedix_async_log_level>(site.level);
+            r.file = site.file;
+            r.line = site.line;
+            r.suppressed = repeated;
+            if (!r.deferred.capture(fmt, std::forward<args_t>(args)...)) {
+                r.message = cvedix_deferred_format::format_now(fmt, args...);
+            }
+            return push(std::move(r));
+        }
+
+        uint64_t written_count() const { return written; }
+        uint64_t dropped_count() const { return dropped; }
+    };
+}
+
+// levels above this one (more verbose) are removed at compile time, arguments are never evaluated.
+// 1: ERROR, 2: WARN, 3: INFO, 4: DEBUG. e.g. add -DCVEDIX_ASYNC_LOG_COMPILED_LEVEL=3 to release builds.
+#ifndef CVEDIX_ASYNC_LOG_COMPILED_LEVEL
+#define CVEDIX_ASYNC_LOG_COMPILED_LEVEL 4
+#endif
+
+// runtime level is checked before the message expression is evaluated, so a disabled level costs one atomic load
+#define CVEDIX_ASYNC_LOG(level, message) \
+    do { \
+        auto& cvedix_async_logger_ = cvedix_utils::cvedix_async_logger::get(); \
+        if (cvedix_async_logger_.enabled(level)) { \
+            cvedix_async_logger_.log(level, __FILE__, __LINE__, message); \
+        } \
+    } while (0)
+
+// format string checked against arguments at compile time, fails to compile if it is not a string literal
+// ("" fmt does not concatenate with a pointer). arguments are not evaluated
+#define CVEDIX_ASYNC_FORMAT_LITERAL_(fmt, ...) "" fmt
+#define CVEDIX_ASYNC_FORMAT_CHECK_(...) \
+    static_assert(decltype(cvedix_utils::cvedix_deferred_format::arg_types(__VA_ARGS__))::matches(CVEDIX_ASYNC_FORMAT_LITERAL_(__VA_ARGS__, 0)), \
+                  "format of CVEDIX_ASYNC_*F does not match its arguments")
+
+// printf-style with deferred formatting: CVEDIX_ASYNC_INFOF("channel %d, track %d", channel, track_id)
+#define CVEDIX_ASYNC_LOGF(level, ...) \
+    do { \
+        CVEDIX_ASYNC_FORMAT_CHECK_(__VA_ARGS__); \
+        auto& cvedix_async_logger_ = cvedix_utils::cvedix_async_logger::get(); \
+        if (cvedix_async_logger_.enabled(level)) { \
+            cvedix_async_logger_.logf(level, __FILE__, __LINE__, __VA_ARGS__); \
+        } \
+    } while (0)
+
+// compiled out, still type-checked
+#define CVEDIX_ASYNC_LOG_ELIDED(message) do { if (false) { (void)(message); } } while (0)
+#define CVEDIX_ASYNC_LOGF_ELIDED(...) \
+    do { \
+        CVEDIX_ASYNC_FORMAT_CHECK_(__VA_ARGS__); \
+        if (false) { cvedix_utils::cvedix_deferred_format::check(__VA_ARGS__); } \
+    } while (0)
+
+#define CVEDIX_ASYNC_ERROR(message) CVEDIX_ASYNC_LOG(cvedix_utils::cvedix_async_log_level::ERROR, message)
+#define CVEDIX_ASYNC_ERRORF(...) CVEDIX_ASYNC_LOGF(cvedix_utils::cvedix_async_log_level::ERROR, __VA_ARGS__)
+
+#if CVEDIX_ASYNC_LOG_COMPILED_LEVEL >= 2
+#define CVEDIX_ASYNC_WARN(message) CVEDIX_ASYNC_LOG(cvedix_utils::cvedix_async_log_level::WARN, message)
+#define CVEDIX_ASYNC_WARNF(...) CVEDIX_ASYNC_LOGF(cvedix_utils::cvedix_async_log_level::WARN, __VA_ARGS__)
+#else
+#define CVEDIX_ASYNC_WARN(message) CVEDIX_ASYNC_LOG_ELIDED(message)
+#define CVEDIX_ASYNC_WARNF(...) CVEDIX_ASYNC_LOGF_ELIDED(__VA_ARGS__)
+#endif
+
+#if CVEDIX_ASYNC_LOG_COMPILED_LEVEL >= 3
+#define CVEDIX_ASYNC_INFO(message) CVEDIX_ASYNC_LOG(cvedix_utils::cvedix_async_log_level::INFO, message)
+#define CVEDIX_ASYNC_INFOF(...) CVEDIX_ASYNC_LOGF(cvedix_utils::cvedix_async_log_level::INFO, __VA_ARGS__)
+#else
+#define CVEDIX_ASYNC_INFO(message) CVEDIX_ASYNC_LOG_ELIDED(message)
+#define CVEDIX_ASYNC_INFOF(...) CVEDIX_ASYNC_LOGF_ELIDED(__VA_ARGS__)
+#endif
+
+#if CVEDIX_ASYNC_LOG_COMPILED_LEVEL >= 4
+#define CVEDIX_ASYNC_DEBUG(message) CVEDIX_ASYNC_LOG(cvedix_utils::cvedix_async_log_level::DEBUG, message)
+#define CVEDIX_ASYNC_DEBUGF(...) CVEDIX_ASYNC_LOGF(cvedix_utils::cvedix_async_log_level::DEBUG, __VA_ARGS__)
+#else
+#define CVEDIX_ASYNC_DEBUG(message) CVEDIX_ASYNC_LOG_ELIDED(message)
+#define CVEDIX_ASYNC_DEBUGF(...) CVEDIX_ASYNC_LOGF_ELIDED(__VA_ARGS__)
+#endif
+
+// rate-limited variants, level is a short name (ERROR, WARN, INFO, DEBUG):
+// CVEDIX_ASYNC_LOG_EVERY_MS(ERROR, 5000, cvedix_utils::string_format("[%s] reconnect failed", name.c_str()));
+// CVEDIX_ASYNC_LOGF_EVERY_N(WARN, 1000, "[%s] broking cache is full", node_name);
+// EVERY_N logs hits 1, n+1, 2n+1..., FIRST_N the first n hits, EVERY_MS at most one hit per interval.
+// every call site counts its own hits with lock-free atomics, a logged hit carries "(+N suppressed)" and the writer
+// thread writes "last message repeated N times" when a flood stops. hits of disabled levels are not counted.
+#define CVEDIX_ASYNC_LOG_RATE_LIMITED_(level, rule, limit, log_func, ...) \
+    do { \
+        if (static_cast<int>(cvedix_utils::cvedix_async_log_level::level) <= CVEDIX_ASYNC_LOG_COMPILED_LEVEL) { \
+            auto& cvedix_async_logger_ = cvedix_utils::cvedix_async_logger::get(); \
+            if (cvedix_async_logger_.enabled(cvedix_utils::cvedix_async_log_level::level)) { \
+                static cvedix_utils::cvedix_log_site cvedix_log_site_(__FILE__, __LINE__, static_cast<int>(cvedix_utils::cvedix_async_log_level::level)); \
+                uint64_t cvedix_log_repeated_ = 0; \
+                if (cvedix_log_site_.rule(limit, cvedix_log_repeated_)) { \
+                    cvedix_async_logger_.log_func(cvedix_log_site_, cvedix_log_repeated_, __VA_ARGS__); \
+                } \
+            } \
+        } \
+    } while (0)
+
+#define CVEDIX_ASYNC_LOG_EVERY_N(level, n, message) CVEDIX_ASYNC_LOG_RATE_LIMITED_(level, every_n, n, log, message)
+#define CVEDIX_ASYNC_LOG_FIRST_N(level, n, message) CVEDIX_ASYNC_LOG_RATE_LIMITED_(level, first_n, n, log, message)
+#define CVEDIX_ASYNC_LOG_EVERY_MS(level, ms, message) CVEDIX_ASYNC_LOG_RATE_LIMITED_(level, every_ms, ms, log, message)
+#define CVEDIX_ASYNC_LOGF_EVERY_N(level, n, ...) \
+    do { \
+        CVEDIX_ASYNC_FORMAT_CHECK_(__VA_ARGS__); \
+        CVEDIX_ASYNC_LOG_RATE_LIMITED_(level, every_n, n, logf, __VA_ARGS__); \
+    } while (0)
+#define CVEDIX_ASYNC_LOGF_FIRST_N(level, n, ...) \
+    do { \
+        CVEDIX_ASYNC_FORMAT_CHECK_(__VA_ARGS__); \
+        CVEDIX_ASYNC_LOG_RATE_LIMITED_(level, first_n, n, logf, __VA_ARGS__); \
+    } while (0)
+#define CVEDIX_ASYNC_LOGF_EVERY_MS(level, ms, ...) \
+    do { \
+        CVEDIX_ASYNC_FORMAT_CHECK_(__VA_ARGS__); \
+        CVEDIX_ASYNC_LOG_RATE_LIMITED_(level, every_ms, ms, logf, __VA_ARGS__); \
+    } while (0)
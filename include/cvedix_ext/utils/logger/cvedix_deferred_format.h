@@ -0,0 +1,283 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <new>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace cvedix_utils {
+    // printf-style format string plus captured arguments, formatted later (on the writer thread of the async logger)
+    // instead of on the caller. arguments are stored inline (no allocation), c strings are copied into std::string
+    // at capture so they can not dangle, std::string arguments are passed to %s.
+    // supported arguments: arithmetic, enums, pointers (%p), c strings and std::string. `fmt` MUST be a string literal
+    // (it is kept as pointer). the CVEDIX_ASYNC_*F macros enforce both at compile time (see format_args), a wrong
+    // format would otherwise only show up as a crash of the writer thread.
+    class cvedix_deferred_format {
+    private:
+        static constexpr size_t capacity = 96;
+        enum class op { FORMAT, MOVE, DESTROY };
+        typedef void (*ops_t)(op, void* self, void* other, std::string* out);
+
+        alignas(std::max_align_t) unsigned char storage[capacity];
+        ops_t ops = nullptr;
+
+        template<typename T>
+        using stored_t = std::conditional_t<std::is_same<std::decay_t<T>, const char*>::value || std::is_same<std::decay_t<T>, char*>::value,
+                                            std::string, std::decay_t<T>>;
+
+        template<typename tuple_t>
+        struct holder {
+            const char* fmt;
+            tuple_t args;
+        };
+
+        static const char* pass(const std::string& s) {
+            return s.c_str();
+        }
+        template<typename T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
+        static auto pass(const T& v) {
+            return static_cast<std::underlying_type_t<T>>(v);
+        }
+        template<typename T, typename std::enable_if<!std::is_enum<T>::value, int>::type = 0>
+        static const T& pass(const T& v) {
+            return v;
+        }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-security"
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+        template<typename... args_t>
+        static void append(std::string& out, const char* fmt, const args_t&... args) {
+            char buffer[256];
+            auto n = std::snprintf(buffer, sizeof(buffer), fmt, args...);
+            if (n < 0) {
+                return;
+            }
+            if (static_cast<size_t>(n) < sizeof(buffer)) {
+                out.append(buffer, n);
+                return;
+            }
+            auto offset = out.size();
+            out.resize(offset + n + 1);
+            std::snprintf(&out[offset], n + 1, fmt, args...);
+            out.resize(offset + n);
+        }
+#pragma GCC diagnostic pop
+
+        template<typename holder_t>
+        static void operate(op o, void* self, void* other, std::string* out) {
+            auto h = static_cast<holder_t*>(self);
+            switch (o) {
+            case op::FORMAT:
+                std::apply([&](const auto&... a) { append(*out, h->fmt, pass(a)...); }, h->args);
+                break;
+            case op::MOVE:
+                new (other) holder_t(std::move(*h));
+                break;
+            case op::DESTROY:
+                h->~holder_t();
+                break;
+            }
+        }
+
+    public:
+        // compile-time printf check against argument types as they are passed at format time (std::string and c
+        // strings to %s, enums as their underlying type), same rules as -Wformat: conversion kind, integer size
+        // implied by length modifier, argument count, no %n.
+        // usage: static_assert(decltype(cvedix_deferred_format::arg_types(fmt, args...))::matches(fmt), "...")
+        template<typename... args_t>
+        struct format_args {
+        private:
+            enum class kind { INTEGER, FLOATING, STRING, POINTER, OTHER };
+            struct info {
+                kind k = kind::OTHER;
+                size_t size = 0;
+            };
+
+            template<typename T>
+            static constexpr info info_of() {
+                typedef stored_t<T> D;
+                if constexpr (std::is_same<D, std::string>::value) {
+                    return {kind::STRING, 0};
+                }
+                else if constexpr (std::is_enum<D>::value) {
+                    return {kind::INTEGER, sizeof(std::underlying_type_t<D>)};
+                }
+                else if constexpr (std::is_integral<D>::value) {
+                    return {kind::INTEGER, sizeof(D)};
+                }
+                else if constexpr (std::is_floating_point<D>::value) {
+                    return {kind::FLOATING, sizeof(D)};
+                }
+                else if constexpr (std::is_pointer<D>::value) {
+                    return {kind::POINTER, sizeof(D)};
+                }
+                else {
+                    return {kind::OTHER, 0};
+                }
+            }
+
+            static constexpr bool is_digit(char c) {
+                return c >= '0' && c <= '9';
+            }
+
+        public:
+            static constexpr bool matches(const char* f) {
+                constexpr info infos[] = {info_of<args_t>()..., info()};
+                size_t next = 0;
+                // `*` width and precision take an int argument
+                auto take_star = [&]() {
+                    if (next >= sizeof...(args_t) || infos[next].k != kind::INTEGER || infos[next].size > sizeof(int)) {
+                        return false;
+                    }
+                    next++;
+                    return true;
+                };
+                for (; *f; f++) {
+                    if (*f != '%') {
+                        continue;
+                    }
+                    f++;
+                    if (*f == '%') {
+                        continue;
+                    }
+                    while (*f == '-' || *f == '+' || *f == ' ' || *f == '#' || *f == '0') f++;
+                    if (*f == '*') {
+                        if (!take_star()) return false;
+                        f++;
+                    }
+                    while (is_digit(*f)) f++;
+                    if (*f == '.') {
+                        f++;
+                        if (*f == '*') {
+                            if (!take_star()) return false;
+                            f++;
+                        }
+                        while (is_digit(*f)) f++;
+                    }
+                    size_t int_size = 0;    // 0: int or smaller (promoted)
+                    bool long_double = false;
+                    if (*f == 'h') {
+                        f++;
+                        if (*f == 'h') f++;
+                    }
+                    else if (*f == 'l') {
+                        f++;
+                        int_size = sizeof(long);
+                        if (*f == 'l') {
+                            f++;
+                            int_size = sizeof(long long);
+                        }
+                    }
+                    else if (*f == 'z') { f++; int_size = sizeof(size_t); }
+                    else if (*f == 'j') { f++; int_size = sizeof(intmax_t); }
+                    else if (*f == 't') { f++; int_size = sizeof(ptrdiff_t); }
+                    else if (*f == 'L') { f++; long_double = true; }
+
+                    if (next >= sizeof...(args_t)) {
+                        return false;   // more conversions than arguments
+                    }
+                    auto a = infos[next++];
+                    switch (*f) {
+                    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+                        if (a.k != kind::INTEGER || (int_size == 0 ? a.size > sizeof(int) : a.size != int_size)) return false;
+                        break;
+                    case 'c':
+                        if (a.k != kind::INTEGER || a.size > sizeof(int)) return false;
+                        break;
+                    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                        if (a.k != kind::FLOATING || (a.size == sizeof(long double)) != long_double) return false;
+                        break;
+                    case 's':
+                        if (a.k != kind::STRING) return false;
+                        break;
+                    case 'p':
+                        if (a.k != kind::POINTER && a.k != kind::STRING) return false;
+                        break;
+                    default:
+                        return false;   // %n, unknown conversion or trailing '%'
+                    }
+                }
+                return next == sizeof...(args_t);
+            }
+        };
+
+        // unevaluated, only gives the argument types of a call to format_args
+        template<typename... args_t>
+        static format_args<args_t...> arg_types(const char*, const args_t&...);
+
+        cvedix_deferred_format() = default;
+        ~cvedix_deferred_format() {
+            reset();
+        }
+        cvedix_deferred_format(cvedix_deferred_format&& other) noexcept {
+            *this = std::move(other);
+        }
+        cvedix_deferred_format& operator=(cvedix_deferred_format&& other) noexcept {
+            if (this != &other) {
+                reset();
+                if (other.ops) {
+                    other.ops(op::MOVE, other.storage, storage, nullptr);
+                    ops = other.ops;
+                    other.reset();
+                }
+            }
+            return *this;
+        }
+        cvedix_deferred_format(const cvedix_deferred_format&) = delete;
+        cvedix_deferred_format& operator=(const cvedix_deferred_format&) = delete;
+
+        // compile-time check of argument types only, used where logging is compiled out
+        template<typename... args_t>
+        static void check(const char*, const args_t&...) {
+            static_assert(((std::is_arithmetic<stored_t<args_t>>::value || std::is_enum<stored_t<args_t>>::value ||
+                            std::is_pointer<stored_t<args_t>>::value || std::is_same<stored_t<args_t>, std::string>::value) && ...),
+                          "deferred format supports arithmetic, enum, pointer and string arguments only");
+        }
+
+        // false if arguments do not fit inline, format on caller with format_now(...) then
+        template<typename... args_t>
+        bool capture(const char* fmt, args_t&&... args) {
+            check(fmt, args...);
+            typedef holder<std::tuple<stored_t<args_t>...>> holder_t;
+            if constexpr (sizeof(holder_t) > capacity || alignof(holder_t) > alignof(std::max_align_t)) {
+                return false;
+            }
+            else {
+                reset();
+                new (storage) holder_t{fmt, std::tuple<stored_t<args_t>...>(std::forward<args_t>(args)...)};
+                ops = &operate<holder_t>;
+                return true;
+            }
+        }
+
+        template<typename... args_t>
+        static std::string format_now(const char* fmt, const args_t&... args) {
+            std::string out;
+            append(out, fmt, pass(stored_t<args_t>(args))...);
+            return out;
+        }
+
+        bool empty() const {
+            return ops == nullptr;
+        }
+
+        // append formatted text to out
+        void format(std::string& out) const {
+            if (ops) {
+                ops(op::FORMAT, const_cast<unsigned char*>(storage), nullptr, &out);
+            }
+        }
+
+        void reset() {
+            if (ops) {
+                ops(op::DESTROY, storage, nullptr, nullptr);
+                ops = nullptr;
+            }
+        }
+    };
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace cvedix_utils {
+    // state of one rate-limited log call site, a static instance per macro expansion (see macros below).
+    // deciding whether a hit is logged is one or two relaxed atomics, no lock, no allocation.
+    // hits that are not logged are counted, the count is attached to the next logged hit ("+N suppressed") or
+    // reported as "last message repeated N times" once the flood stops: by the writer thread of the async logger for
+    // its own macros, by cvedix_log_site_sweeper through the wrapped macro for sites of other loggers (sdk CVEDIX_*).
+    // trivially destructible and constant-initialized on purpose: sites stay valid while statics are destroyed.
+    class cvedix_log_site {
+    private:
+        std::atomic<uint64_t> hits {0};
+        std::atomic<uint64_t> suppressed {0};
+        std::atomic<int64_t> next_allowed {0};   // steady clock ns, EVERY_MS only
+        std::atomic<int64_t> last_hit {0};       // steady clock ns of last suppressed hit
+        std::atomic<int64_t> last_report {0};    // steady clock ns of last logged hit or summary
+        std::atomic<bool> listed {false};
+        cvedix_log_site* next = nullptr;
+
+        static std::atomic<cvedix_log_site*>& head() {
+            static std::atomic<cvedix_log_site*> h {nullptr};
+            return h;
+        }
+
+        static int64_t steady_now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        bool allow(uint64_t& repeated, int64_t now) {
+            repeated = suppressed.exchange(0, std::memory_order_relaxed);
+            last_report.store(now, std::memory_order_relaxed);
+            return true;
+        }
+
+        bool suppress(int64_t now) {
+            suppressed.fetch_add(1, std::memory_order_relaxed);
+            last_hit.store(now, std::memory_order_relaxed);
+            // summaries are swept for sites which can write them: async logger macros (level) or wrapped macros (emit)
+            if ((level > 0 || emit) && !listed.load(std::memory_order_relaxed) && !listed.exchange(true)) {
+                auto h = head().load(std::memory_order_relaxed);
+                do {
+                    next = h;
+                } while (!head().compare_exchange_weak(h, this, std::memory_order_release, std::memory_order_relaxed));
+                if (emit) {
+                    start_sweeper();
+                }
+            }
+            return false;
+        }
+
+        static void start_sweeper();
+
+    public:
+        const char* file;
+        int line;
+        int level;      // cvedix_async_log_level, 0 if logged through another logger
+        void (*emit)(const std::string&);   // writes a summary through the other logger (level 0)
+
+        constexpr cvedix_log_site(const char* file, int line, int level = 0, void (*emit)(const std::string&) = nullptr):
+                                  file(file), line(line), level(level), emit(emit) {}
+
+        // log hits 1, n+1, 2n+1, ...
+        bool every_n(uint64_t n, uint64_t& repeated) {
+            auto h = hits.fetch_add(1, std::memory_order_relaxed);
+            if (n <= 1 || h % n == 0) {
+                return allow(repeated, steady_now());
+            }
+            return suppress(steady_now());
+        }
+
+        // log the first n hits only, the rest is counted and summarized
+        bool first_n(uint64_t n, uint64_t& repeated) {
+            auto now = steady_now();
+            if (hits.fetch_add(1, std::memory_order_relaxed) < n) {
+                return allow(repeated, now);
+            }
+            return suppress(now);
+        }
+
+        // log at most one hit per interval, the first hit after the interval wins
+        bool every_ms(int64_t interval_ms, uint64_t& repeated) {
+            auto now = steady_now();
+            auto allowed = next_allowed.load(std::memory_order_relaxed);
+            if (now >= allowed && next_allowed.compare_exchange_strong(allowed, now + interval_ms * 1000000, std::memory_order_relaxed)) {
+                return allow(repeated, now);
+            }
+            return suppress(now);
+        }
+
+        // visit sites holding suppressed hits that went quiet for `quiet_ms`, or were not reported for `max_silence_ms`
+        // (a FIRST_N flood that goes on forever still shows up). `report(site, count)` is called with the taken count.
+        // all = true takes every pending count (shutdown). emitting selects sites of other loggers instead of async ones.
+        template<typename report_t>
+        static void sweep(report_t report, int64_t quiet_ms = 1000, int64_t max_silence_ms = 10000, bool all = false, bool emitting = false) {
+            auto now = steady_now();
+            for (auto s = head().load(std::memory_order_acquire); s; s = s->next) {
+                if ((s->emit != nullptr) != emitting || s->suppressed.load(std::memory_order_relaxed) == 0) {
+                    continue;
+                }
+                if (!all && now - s->last_hit.load(std::memory_order_relaxed) < quiet_ms * 1000000 &&
+                    now - s->last_report.load(std::memory_order_relaxed) < max_silence_ms * 1000000) {
+                    continue;
+                }
+                s->last_report.store(now, std::memory_order_relaxed);
+                if (auto n = s->suppressed.exchange(0, std::memory_order_relaxed)) {
+                    report(*s, n);
+                }
+            }
+        }
+
+        // message of a logged hit with the number of hits suppressed before it
+        static std::string annotate(std::string message, uint64_t repeated) {
+            if (repeated > 0) {
+                message += " (+" + std::to_string(repeated) + " suppressed)";
+            }
+            return message;
+        }
+    };
+
+    // writes "last message repeated N times" for rate-limited sites of other loggers (CVEDIX_LOG_EVERY_MS(CVEDIX_ERROR, ...)),
+    // which have no writer thread of their own. started by the first suppressed hit of such a site, checks every
+    // 250ms, pending counts are written when the process exits (destroyed before loggers created earlier).
+    class cvedix_log_site_sweeper {
+    private:
+        std::mutex lock;
+        std::condition_variable stop_requested;
+        bool stop = false;
+        std::thread sweeper;
+
+        static void sweep_sites(bool all) {
+            cvedix_log_site::sweep([](const cvedix_log_site& site, uint64_t n) {
+                site.emit("last message repeated " + std::to_string(n) + " times");
+            }, 1000, 10000, all, true);
+        }
+
+        void run() {
+            std::unique_lock<std::mutex> guard(lock);
+            while (!stop_requested.wait_for(guard, std::chrono::milliseconds(250), [this]() { return stop; })) {
+                guard.unlock();
+                sweep_sites(false);
+                guard.lock();
+            }
+        }
+
+        cvedix_log_site_sweeper(): sweeper(&cvedix_log_site_sweeper::run, this) {}
+
+    public:
+        static cvedix_log_site_sweeper& get() {
+            static cvedix_log_site_sweeper instance;
+            return instance;
+        }
+        cvedix_log_site_sweeper(const cvedix_log_site_sweeper&) = delete;
+        cvedix_log_site_sweeper& operator=(const cvedix_log_site_sweeper&) = delete;
+        ~cvedix_log_site_sweeper() {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stop = true;
+            }
+            stop_requested.notify_all();
+            if (sweeper.joinable()) {
+                sweeper.join();
+            }
+            sweep_sites(true);
+        }
+    };
+
+    inline void cvedix_log_site::start_sweeper() {
+        cvedix_log_site_sweeper::get();
+    }
+}
+
+// rate-limited wrappers for any logger macro taking a std::string, e.g. CVEDIX_ERROR of the sdk logger:
+// CVEDIX_LOG_EVERY_MS(CVEDIX_ERROR, 5000, cvedix_utils::string_format("[%s] MQTT publish failed: %s", ...))
+// the message is only built for hits that are logged, "last message repeated N times" is written through the same
+// macro once a flood stops (see cvedix_log_site_sweeper).
+#define CVEDIX_LOG_RATE_LIMITED_(log_macro, rule, limit, message) \
+    do { \
+        static cvedix_utils::cvedix_log_site cvedix_log_site_(__FILE__, __LINE__, 0, [](const std::string& cvedix_log_summary_) { log_macro(cvedix_log_summary_); }); \
+        uint64_t cvedix_log_repeated_ = 0; \
+        if (cvedix_log_site_.rule(limit, cvedix_log_repeated_)) { \
+            log_macro(cvedix_utils::cvedix_log_site::annotate(message, cvedix_log_repeated_)); \
+        } \
+    } while (0)
+
+#define CVEDIX_LOG_EVERY_N(log_macro, n, message) CVEDIX_LOG_RATE_LIMITED_(log_macro, every_n, n, message)
+#define CVEDIX_LOG_FIRST_N(log_macro, n, message) CVEDIX_LOG_RATE_LIMITED_(log_macro, first_n, n, message)
+#define CVEDIX_LOG_EVERY_MS(log_macro, ms, message) CVEDIX_LOG_RATE_LIMITED_(log_macro, every_ms, ms, message)
@@ -0,0 +1,333 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cvedix_utils {
+    typedef std::vector<std::pair<std::string, std::string>> cvedix_metric_labels;
+
+    // updates of one metric are spread over this many cache lines, threads are assigned round-robin.
+    // with up to 16 updating threads every thread owns its cell, an update is one uncontended relaxed atomic add.
+    constexpr size_t cvedix_metric_shards = 16;
+
+    inline size_t cvedix_metric_shard() {
+        static std::atomic<size_t> next {0};
+        thread_local size_t shard = next++ % cvedix_metric_shards;
+        return shard;
+    }
+
+    // base of metrics kept by cvedix_metrics_registry
+    class cvedix_metric {
+    public:
+        virtual ~cvedix_metric() = default;
+        // append samples in prometheus text format, `labels` is already rendered ({a="b"} or empty)
+        virtual void render(const std::string& name, const std::string& labels, std::string& out) const = 0;
+
+    protected:
+        static void append_value(std::string& out, double value) {
+            char buffer[32];
+            if (std::isnan(value)) {
+                out += "NaN";
+                return;
+            }
+            if (std::isinf(value)) {
+                out += value > 0 ? "+Inf" : "-Inf";
+                return;
+            }
+            std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+            out += buffer;
+        }
+        static void append_sample(std::string& out, const std::string& name, const std::string& labels, double value) {
+            out += name;
+            out += labels;
+            out += ' ';
+            append_value(out, value);
+            out += '\n';
+        }
+        // {a="b"} + extra label
+        static std::string with_label(const std::string& labels, const std::string& key, const std::string& value) {
+            auto extra = key + "=\"" + value + "\"";
+            return labels.empty() ? "{" + extra + "}" : labels.substr(0, labels.size() - 1) + "," + extra + "}";
+        }
+    };
+
+    // monotonic counter, sum of per-thread cells
+    class cvedix_counter: public cvedix_metric {
+    private:
+        struct alignas(64) cell {
+            std::atomic<uint64_t> value {0};
+        };
+        cell cells[cvedix_metric_shards];
+
+    public:
+        void add(uint64_t n = 1) {
+            cells[cvedix_metric_shard()].value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        uint64_t value() const {
+            uint64_t sum = 0;
+            for (auto& c: cells) {
+                sum += c.value.load(std::memory_order_relaxed);
+            }
+            return sum;
+        }
+
+        virtual void render(const std::string& name, const std::string& labels, std::string& out) const override {
+            append_sample(out, name, labels, static_cast<double>(value()));
+        }
+    };
+
+    // last set value
+    class cvedix_gauge: public cvedix_metric {
+    private:
+        std::atomic<double> current {0};
+
+    public:
+        void set(double v) {
+            current.store(v, std::memory_order_relaxed);
+        }
+
+        double value() const {
+            return current.load(std::memory_order_relaxed);
+        }
+
+        virtual void render(const std::string& name, const std::string& labels, std::string& out) const override {
+            append_sample(out, name, labels, value());
+        }
+    };
+
+    // bucketed distribution (prometheus histogram, cumulative `le` buckets + sum + count).
+    // counts are kept per thread cell like cvedix_counter, quantiles are interpolated inside buckets.
+    class cvedix_histogram: public cvedix_metric {
+    private:
+        struct alignas(64) cell {
+            std::unique_ptr<std::atomic<uint64_t>[]> counts;    // bounds.size() + 1 (+Inf)
+            std::atomic<double> sum {0};
+        };
+        std::vector<double> bounds;
+        std::unique_ptr<cell[]> cells;
+
+    public:
+        // upper bounds of buckets, ascending
+        explicit cvedix_histogram(std::vector<double> bounds): bounds(bounds), cells(new cell[cvedix_metric_shards]) {
+            std::sort(this->bounds.begin(), this->bounds.end());
+            for (size_t i = 0; i < cvedix_metric_shards; i++) {
+                cells[i].counts.reset(new std::atomic<uint64_t>[this->bounds.size() + 1]);
+                for (size_t b = 0; b <= this->bounds.size(); b++) {
+                    cells[i].counts[b] = 0;
+                }
+            }
+        }
+
+        // 0.5ms .. 2.5s, for per-frame processing latency in seconds
+        static std::vector<double> latency_bounds() {
+            return {0.0005, 0.001, 0.002, 0.005, 0.01, 0.02, 0.035, 0.05, 0.075, 0.1, 0.15, 0.25, 0.5, 1, 2.5};
+        }
+
+        void observe(double v) {
+            auto& c = cells[cvedix_metric_shard()];
+            auto bucket = std::lower_bound(bounds.begin(), bounds.end(), v) - bounds.begin();
+            c.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+            auto sum = c.sum.load(std::memory_order_relaxed);
+            while (!c.sum.compare_exchange_weak(sum, sum + v, std::memory_order_relaxed)) {}
+        }
+
+        // per-bucket (not cumulative) counts summed over cells, last one is +Inf
+        std::vector<uint64_t> snapshot() const {
+            std::vector<uint64_t> counts(bounds.size() + 1, 0);
+            for (size_t i = 0; i < cvedix_metric_shards; i++) {
+                for (size_t b = 0; b < counts.size(); b++) {
+                    counts[b] += cells[i].counts[b].load(std::memory_order_relaxed);
+                }
+            }
+            return counts;
+        }
+
+        // q in [0, 1] of a snapshot (or of the difference of two snapshots), NAN if empty
+        double quantile(const std::vector<uint64_t>& counts, double q) const {
+            uint64_t total = 0;
+            for (auto n: counts) {
+                total += n;
+            }
+            if (total == 0) {
+                return NAN;
+            }
+            auto rank = q * total;
+            uint64_t seen = 0;
+            for (size_t b = 0; b < counts.size(); b++) {
+                if (counts[b] == 0 || seen + counts[b] < rank) {
+                    seen += counts[b];
+                    continue;
+                }
+                if (b == bounds.size()) {
+                    return bounds.empty() ? NAN : bounds.back();   // beyond last bound, like histogram_quantile
+                }
+                auto lower = b == 0 ? 0.0 : bounds[b - 1];
+                return lower + (bounds[b] - lower) * (rank - seen) / counts[b];
+            }
+            return bounds.empty() ? NAN : bounds.back();
+        }
+
+        virtual void render(const std::string& name, const std::string& labels, std::string& out) const override {
+            auto counts = snapshot();
+            double sum = 0;
+            for (size_t i = 0; i < cvedix_metric_shards; i++) {
+                sum += cells[i].sum.load(std::memory_order_relaxed);
+            }
+            uint64_t cumulative = 0;
+            char le[32];
+            for (size_t b = 0; b < counts.size(); b++) {
+                cumulative += counts[b];
+                if (b < bounds.size()) {
+                    std::snprintf(le, sizeof(le), "%g", bounds[b]);
+                }
+                append_sample(out, name + "_bucket", with_label(labels, "le", b < bounds.size() ? le : "+Inf"), static_cast<double>(cumulative));
+            }
+            append_sample(out, name + "_sum", labels, sum);
+            append_sample(out, name + "_count", labels, static_cast<double>(cumulative));
+        }
+    };
+
+    // named metric families with labels, rendered in prometheus text exposition format (version 0.0.4).
+    // creating a metric takes a lock, keep the returned pointer and update it on the hot path (no lock, no lookup).
+    // collectors run before every render to refresh values computed on demand (fps over last interval, ...).
+    //
+    // usage:
+    // auto frames = cvedix_metrics_registry::get().counter("cvedix_frames_total", "frames handled", {{"node", "osd_0"}});
+    // frames->add();
+    class cvedix_metrics_registry {
+    private:
+        struct family {
+            std::string help;
+            std::string type;
+            std::map<std::string, std::shared_ptr<cvedix_metric>> metrics;   // by rendered labels
+        };
+        std::map<std::string, family> families;
+        std::map<int, std::function<void()>> collectors;
+        int next_collector = 0;
+        std::mutex families_lock;
+        std::mutex render_lock;     // one render (and collector run) at a time
+
+        static std::string render_labels(const cvedix_metric_labels& labels) {
+            if (labels.empty()) {
+                return "";
+            }
+            std::string out = "{";
+            for (auto& l: labels) {
+                if (out.size() > 1) {
+                    out += ',';
+                }
+                out += l.first + "=\"";
+                for (auto ch: l.second) {
+                    if (ch == '\\' || ch == '"') {
+                        out += '\\';
+                        out += ch;
+                    }
+                    else if (ch == '\n') {
+                        out += "\\n";
+                    }
+                    else {
+                        out += ch;
+                    }
+                }
+                out += '"';
+            }
+            return out + "}";
+        }
+
+        template<typename metric_t, typename factory_t>
+        std::shared_ptr<metric_t> find_or_create(const std::string& name, const std::string& help, const std::string& type,
+                                                 const cvedix_metric_labels& labels, factory_t factory) {
+            std::lock_guard<std::mutex> guard(families_lock);
+            auto& f = families[name];
+            if (f.type.empty()) {
+                f.help = help;
+                f.type = type;
+            }
+            // same name registered with another type is a programming error, give a detached metric
+            if (f.type != type) {
+                return factory();
+            }
+            auto& m = f.metrics[render_labels(labels)];
+            if (!m) {
+                m = factory();
+            }
+            return std::static_pointer_cast<metric_t>(m);
+        }
+
+    public:
+        cvedix_metrics_registry() = default;
+        cvedix_metrics_registry(const cvedix_metrics_registry&) = delete;
+        cvedix_metrics_registry& operator=(const cvedix_metrics_registry&) = delete;
+
+        // process-wide default registry
+        static cvedix_metrics_registry& get() {
+            static cvedix_metrics_registry registry;
+            return registry;
+        }
+
+        std::shared_ptr<cvedix_counter> counter(const std::string& name, const std::string& help, const cvedix_metric_labels& labels = {}) {
+            return find_or_create<cvedix_counter>(name, help, "counter", labels, []() { return std::make_shared<cvedix_counter>(); });
+        }
+
+        std::shared_ptr<cvedix_gauge> gauge(const std::string& name, const std::string& help, const cvedix_metric_labels& labels = {}) {
+            return find_or_create<cvedix_gauge>(name, help, "gauge", labels, []() { return std::make_shared<cvedix_gauge>(); });
+        }
+
+        std::shared_ptr<cvedix_histogram> histogram(const std::string& name, const std::string& help, const cvedix_metric_labels& labels = {},
+                                                    const std::vector<double>& bounds = cvedix_histogram::latency_bounds()) {
+            return find_or_create<cvedix_histogram>(name, help, "histogram", labels, [&]() { return std::make_shared<cvedix_histogram>(bounds); });
+        }
+
+        // remove all metrics of a family with these labels (e.g. a node that was removed)
+        void remove(const std::string& name, const cvedix_metric_labels& labels) {
+            std::lock_guard<std::mutex> guard(families_lock);
+            auto f = families.find(name);
+            if (f != families.end()) {
+                f->second.metrics.erase(render_labels(labels));
+            }
+        }
+
+        // returns id for remove_collector(...)
+        int add_collector(std::function<void()> collector) {
+            std::lock_guard<std::mutex> guard(render_lock);
+            collectors[next_collector] = collector;
+            return next_collector++;
+        }
+
+        void remove_collector(int id) {
+            std::lock_guard<std::mutex> guard(render_lock);
+            collectors.erase(id);
+        }
+
+        std::string render() {
+            std::lock_guard<std::mutex> render_guard(render_lock);
+            for (auto& c: collectors) {
+                c.second();
+            }
+            std::string out;
+            std::lock_guard<std::mutex> guard(families_lock);
+            for (auto& f: families) {
+                if (f.second.metrics.empty()) {
+                    continue;
+                }
+                out += "# HELP " + f.first + " " + f.second.help + "\n";
+                out += "# TYPE " + f.first + " " + f.second.type + "\n";
+                for (auto& m: f.second.metrics) {
+                    m.second->render(f.first, m.first, out);
+                }
+            }
+            return out;
+        }
+    };
+}
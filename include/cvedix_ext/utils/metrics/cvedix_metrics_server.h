@@ -0,0 +1,154 @@
+#pragma once
+
+#include "cvedix_ext/utils/metrics/cvedix_metrics.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace cvedix_utils {
+    // minimal HTTP endpoint for prometheus scrapes: GET /metrics returns registry.render() in text format 0.0.4.
+    // one thread, one request per connection (Connection: close), meant for a scraper or curl on a headless box,
+    // not for public exposure: binds to 127.0.0.1 by default, use "0.0.0.0" to let a remote prometheus scrape.
+    //
+    // usage:
+    // cvedix_utils::cvedix_metrics_server server(9464);
+    // server.start();     // curl http://127.0.0.1:9464/metrics
+    class cvedix_metrics_server {
+    private:
+        int port;
+        std::string address;
+        cvedix_metrics_registry& registry;
+        int listen_fd = -1;
+        std::atomic<bool> running {false};
+        std::thread server;
+
+        static void send_all(int fd, const std::string& data) {
+            size_t sent = 0;
+            while (sent < data.size()) {
+                auto n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) {
+                    return;
+                }
+                sent += n;
+            }
+        }
+
+        static std::string response(const std::string& status, const std::string& content_type, const std::string& body) {
+            return "HTTP/1.1 " + status + "\r\nContent-Type: " + content_type + "\r\nContent-Length: " + std::to_string(body.size()) +
+                   "\r\nConnection: close\r\n\r\n" + body;
+        }
+
+        void serve(int fd) {
+            // a scraper sends the whole request at once, do not wait long for slow clients
+            timeval timeout {1, 0};
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            std::string request;
+            char buffer[2048];
+            while (request.find("\r\n\r\n") == std::string::npos && request.size() < 16384) {
+                auto n = ::recv(fd, buffer, sizeof(buffer), 0);
+                if (n <= 0) {
+                    break;
+                }
+                request.append(buffer, n);
+            }
+
+            auto line = request.substr(0, request.find("\r\n"));
+            if (line.compare(0, 4, "GET ") != 0) {
+                send_all(fd, response("405 Method Not Allowed", "text/plain", "only GET\n"));
+                return;
+            }
+            auto path = line.substr(4, line.find(' ', 4) - 4);
+            path = path.substr(0, path.find('?'));
+            if (path == "/metrics") {
+                send_all(fd, response("200 OK", "text/plain; version=0.0.4; charset=utf-8", registry.render()));
+            }
+            else if (path == "/") {
+                send_all(fd, response("200 OK", "text/plain", "cvedix metrics, see /metrics\n"));
+            }
+            else {
+                send_all(fd, response("404 Not Found", "text/plain", "not found\n"));
+            }
+        }
+
+        void run() {
+            pollfd p {listen_fd, POLLIN, 0};
+            while (running) {
+                // wake up regularly to see stop()
+                if (::poll(&p, 1, 200) <= 0) {
+                    continue;
+                }
+                auto fd = ::accept(listen_fd, nullptr, nullptr);
+                if (fd < 0) {
+                    continue;
+                }
+                serve(fd);
+                ::close(fd);
+            }
+        }
+
+    public:
+        cvedix_metrics_server(int port = 9464,
+                              std::string address = "127.0.0.1",
+                              cvedix_metrics_registry& registry = cvedix_metrics_registry::get()):
+                              port(port),
+                              address(address),
+                              registry(registry) {}
+        ~cvedix_metrics_server() {
+            stop();
+        }
+        cvedix_metrics_server(const cvedix_metrics_server&) = delete;
+        cvedix_metrics_server& operator=(const cvedix_metrics_server&) = delete;
+
+        // false if the port can not be bound (in use, bad address)
+        bool start() {
+            if (running) {
+                return true;
+            }
+            listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (listen_fd < 0) {
+                return false;
+            }
+            int on = 1;
+            setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            sockaddr_in addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(static_cast<uint16_t>(port));
+            if (::inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1 ||
+                ::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+                ::listen(listen_fd, 16) != 0) {
+                ::close(listen_fd);
+                listen_fd = -1;
+                return false;
+            }
+            running = true;
+            server = std::thread(&cvedix_metrics_server::run, this);
+            return true;
+        }
+
+        void stop() {
+            if (!running) {
+                return;
+            }
+            running = false;
+            if (server.joinable()) {
+                server.join();
+            }
+            ::close(listen_fd);
+            listen_fd = -1;
+        }
+
+        int get_port() const {
+            return port;
+        }
+    };
+}
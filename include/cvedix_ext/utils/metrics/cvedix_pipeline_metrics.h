@@ -0,0 +1,237 @@
+#pragma once
+
+#include "cvedix/objects/cvedix_frame_meta.h"
+#include "cvedix_ext/utils/cvedix_pipeline_hooks.h"
+#include "cvedix_ext/utils/metrics/cvedix_metrics.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cvedix_utils {
+    // per-node and per-channel pipeline metrics in a cvedix_metrics_registry, the scrapeable counterpart of
+    // cvedix_analysis_board. listens to cvedix_pipeline_hooks, frame metas only:
+    //   cvedix_node_frames_in_total / _out_total        frames entering the node's queue / leaving the node
+    //   cvedix_node_frames_dropped_total                frames a node consumed without passing them on (filtered)
+    //   cvedix_node_queue_depth                         in queue size at last arrival / pop
+    //   cvedix_node_fps                                 output fps since previous scrape
+    //   cvedix_node_latency_seconds                     handling -> handled, histogram (queue wait excluded)
+    //   cvedix_node_latency_quantile_seconds            p50/p90/p99 of the same, over frames since previous scrape
+    //   cvedix_channel_frames_total                     frames produced by src nodes, per channel
+    //   cvedix_channel_targets                          targets on the latest frame reaching a des node, per channel
+    // hot path cost per event is a few relaxed atomic adds on per-thread cells and no lookup, the only lock is the
+    // per-node inflight lock taken by handling/handled (uncontended unless the node hands metas on from another thread).
+    // latency of des nodes is not measured (they do not hand frames on), their out frames are the frames consumed.
+    //
+    // usage:
+    // auto hooks = std::make_shared<cvedix_utils::cvedix_pipeline_hooks>(std::vector<std::shared_ptr<cvedix_nodes::cvedix_node>>{src_0});
+    // hooks->add_listener(std::make_shared<cvedix_utils::cvedix_pipeline_metrics>());
+    // cvedix_utils::cvedix_metrics_server server(9464);
+    // server.start();
+    class cvedix_pipeline_metrics: public cvedix_pipeline_listener {
+    private:
+        static constexpr size_t max_channels = 64;
+        static constexpr size_t max_inflight = 256;
+
+        struct node_state {
+            cvedix_pipeline_node_kind kind;
+            std::shared_ptr<cvedix_counter> frames_in;
+            std::shared_ptr<cvedix_counter> frames_out;
+            std::shared_ptr<cvedix_counter> dropped;
+            std::shared_ptr<cvedix_gauge> queue_depth;
+            std::shared_ptr<cvedix_gauge> fps;
+            std::shared_ptr<cvedix_histogram> latency;
+            std::shared_ptr<cvedix_gauge> quantiles[3];
+
+            // metas being handled and since when. weak_ptr keeps the control block, so a dropped and freed meta can
+            // not be confused with a new one allocated at the same address.
+            // pushed on the node's thread (handling) but matched where the meta is handed on (handled), which is a
+            // worker thread for nodes like cvedix_pipelined_infer_node, hence the lock
+            std::deque<std::pair<std::weak_ptr<cvedix_objects::cvedix_meta>, int64_t>> inflight;
+            std::mutex inflight_lock;
+
+            // collector only
+            uint64_t last_out = 0;
+            int64_t last_collect = 0;
+            std::vector<uint64_t> last_buckets;
+        };
+
+        cvedix_metrics_registry& registry;
+        std::vector<std::unique_ptr<node_state>> states;
+        std::array<std::atomic<cvedix_counter*>, max_channels> channel_frames {};
+        std::array<std::atomic<cvedix_gauge*>, max_channels> channel_targets {};
+        std::vector<std::shared_ptr<cvedix_metric>> channel_metrics;    // owners of the above
+        std::mutex channels_lock;
+        int collector_id = -1;
+
+        static int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        static cvedix_objects::cvedix_frame_meta* frame_of(const std::shared_ptr<cvedix_objects::cvedix_meta>& meta) {
+            if (!meta || meta->meta_type != cvedix_objects::cvedix_meta_type::FRAME) {
+                return nullptr;
+            }
+            return static_cast<cvedix_objects::cvedix_frame_meta*>(meta.get());
+        }
+
+        // created on first frame of a channel, lock-free afterwards
+        template<typename metric_t, typename factory_t>
+        metric_t* channel_metric(std::array<std::atomic<metric_t*>, max_channels>& slots, int channel, factory_t factory) {
+            if (channel < 0 || channel >= static_cast<int>(max_channels)) {
+                return nullptr;
+            }
+            auto m = slots[channel].load(std::memory_order_acquire);
+            if (!m) {
+                std::lock_guard<std::mutex> guard(channels_lock);
+                m = slots[channel].load(std::memory_order_relaxed);
+                if (!m) {
+                    auto created = factory({{"channel", std::to_string(channel)}});
+                    channel_metrics.push_back(created);
+                    m = created.get();
+                    slots[channel].store(m, std::memory_order_release);
+                }
+            }
+            return m;
+        }
+
+        void collect() {
+            auto t = now();
+            for (auto& s: states) {
+                auto out = s->frames_out->value();
+                if (s->last_collect > 0 && t - s->last_collect > 0) {
+                    s->fps->set((out - s->last_out) * 1e9 / (t - s->last_collect));
+                }
+                s->last_out = out;
+                s->last_collect = t;
+
+                auto buckets = s->latency->snapshot();
+                auto window = buckets;
+                if (s->last_buckets.size() == buckets.size()) {
+                    for (size_t b = 0; b < buckets.size(); b++) {
+                        window[b] -= s->last_buckets[b];
+                    }
+                }
+                s->last_buckets = buckets;
+                const double qs[3] = {0.5, 0.9, 0.99};
+                for (int i = 0; i < 3; i++) {
+                    auto v = s->latency->quantile(window, qs[i]);
+                    if (!std::isnan(v)) {   // keep previous value when no frame since previous scrape
+                        s->quantiles[i]->set(v);
+                    }
+                }
+            }
+        }
+
+    public:
+        cvedix_pipeline_metrics(cvedix_metrics_registry& registry = cvedix_metrics_registry::get()): registry(registry) {}
+        ~cvedix_pipeline_metrics() {
+            if (collector_id >= 0) {
+                registry.remove_collector(collector_id);
+            }
+        }
+
+        virtual void on_attached(const std::vector<cvedix_pipeline_node>& nodes) override {
+            for (auto& n: nodes) {
+                cvedix_metric_labels labels {{"node", n.name}};
+                std::unique_ptr<node_state> s(new node_state());
+                s->kind = n.kind;
+                s->frames_in = registry.counter("cvedix_node_frames_in_total", "Frames pushed into the node's in queue.", labels);
+                s->frames_out = registry.counter("cvedix_node_frames_out_total", "Frames sent on by the node (consumed, for des nodes).", labels);
+                s->dropped = registry.counter("cvedix_node_frames_dropped_total", "Frames the node consumed without passing them on.", labels);
+                s->queue_depth = registry.gauge("cvedix_node_queue_depth", "Size of the node's in queue.", labels);
+                s->fps = registry.gauge("cvedix_node_fps", "Output frames per second since previous scrape.", labels);
+                s->latency = registry.histogram("cvedix_node_latency_seconds", "Time from taking a frame out of the in queue to handing it on.", labels);
+                const char* names[3] = {"0.5", "0.9", "0.99"};
+                for (int i = 0; i < 3; i++) {
+                    s->quantiles[i] = registry.gauge("cvedix_node_latency_quantile_seconds", "Node latency quantiles over frames since previous scrape.",
+                                                     {{"node", n.name}, {"quantile", names[i]}});
+                }
+                states.push_back(std::move(s));
+            }
+            collector_id = registry.add_collector([this]() { collect(); });
+        }
+
+        virtual void on_meta_arriving(const cvedix_pipeline_node& node, int queue_size, const std::shared_ptr<cvedix_objects::cvedix_meta>& meta) override {
+            if (!frame_of(meta)) {
+                return;
+            }
+            auto& s = *states[node.index];
+            s.frames_in->add();
+            s.queue_depth->set(queue_size);
+        }
+
+        virtual void on_meta_handling(const cvedix_pipeline_node& node, int queue_size, const std::shared_ptr<cvedix_objects::cvedix_meta>& meta) override {
+            auto frame = frame_of(meta);
+            if (!frame) {
+                return;
+            }
+            auto& s = *states[node.index];
+            s.queue_depth->set(queue_size);
+            if (s.kind == cvedix_pipeline_node_kind::DES) {
+                s.frames_out->add();
+                if (auto targets = channel_metric(channel_targets, frame->channel_index, [&](const cvedix_metric_labels& labels) {
+                        return registry.gauge("cvedix_channel_targets", "Targets on the latest frame reaching a des node.", labels);
+                    })) {
+                    targets->set(frame->targets.size() + frame->face_targets.size());
+                }
+                return;
+            }
+            std::lock_guard<std::mutex> guard(s.inflight_lock);
+            if (s.inflight.size() >= max_inflight) {
+                s.inflight.pop_front();
+            }
+            s.inflight.emplace_back(meta, now());
+        }
+
+        virtual void on_meta_handled(const cvedix_pipeline_node& node, int, const std::shared_ptr<cvedix_objects::cvedix_meta>& meta) override {
+            auto frame = frame_of(meta);
+            if (!frame) {
+                return;
+            }
+            auto& s = *states[node.index];
+            if (s.kind == cvedix_pipeline_node_kind::SRC) {
+                if (auto frames = channel_metric(channel_frames, frame->channel_index, [&](const cvedix_metric_labels& labels) {
+                        return registry.counter("cvedix_channel_frames_total", "Frames produced by src nodes.", labels);
+                    })) {
+                    frames->add();
+                }
+                return;
+            }
+            std::lock_guard<std::mutex> guard(s.inflight_lock);
+            if (s.inflight.empty()) {
+                return;
+            }
+            // metas are normally handed on as the same object, older entries were dropped (filtered) by the node.
+            // a node creating a new meta matches nothing, the oldest entry is used then
+            size_t match = 0;
+            auto same = [&](const std::weak_ptr<cvedix_objects::cvedix_meta>& w) {
+                return !w.owner_before(meta) && !meta.owner_before(w);
+            };
+            while (match < s.inflight.size() && !same(s.inflight[match].first)) {
+                match++;
+            }
+            if (match == s.inflight.size()) {
+                match = 0;
+            }
+            else if (match > 0) {
+                s.dropped->add(match);
+            }
+            s.latency->observe((now() - s.inflight[match].second) / 1e9);
+            s.inflight.erase(s.inflight.begin(), s.inflight.begin() + match + 1);
+        }
+
+        virtual void on_meta_leaving(const cvedix_pipeline_node& node, int, const std::shared_ptr<cvedix_objects::cvedix_meta>& meta) override {
+            if (frame_of(meta)) {
+                states[node.index]->frames_out->add();
+            }
+        }
+    };
+}
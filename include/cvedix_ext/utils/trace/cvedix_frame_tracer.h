@@ -0,0 +1,242 @@
+#pragma once
+
+#include "cvedix/objects/cvedix_frame_meta.h"
+#include "cvedix_ext/utils/cvedix_pipeline_hooks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace cvedix_utils {
+    // per-frame spans of sampled frames (1 in `sample_every` by frame_index), exported as a Chrome trace JSON file
+    // (chrome://tracing, https://ui.perfetto.dev). for every node a sampled frame passes it shows:
+    //   queue   from being pushed into the node's in queue until the node's thread takes it
+    //   handle  from being taken until handed on (des nodes have no end, they only show queue wait)
+    // plus one `frame` span per frame from its src node to the last node it reached (end-to-end latency).
+    // one process per channel, one track per node; args carry frame index and recording thread.
+    // listens to cvedix_pipeline_hooks. every recording thread appends to its own fixed-size buffer (no lock, no
+    // allocation on the hot path), a full buffer drops events. non-sampled frames cost one modulo.
+    //
+    // usage:
+    // auto tracer = std::make_shared<cvedix_utils::cvedix_frame_tracer>(30);
+    // hooks->add_listener(tracer);
+    // ...
+    // tracer->dump("./trace.json");
+    class cvedix_frame_tracer: public cvedix_pipeline_listener {
+    private:
+        enum class stamp { ARRIVE, START, END };
+
+        struct event {
+            int64_t ts;         // steady clock ns
+            int node;
+            stamp type;
+            int channel;
+            int frame_index;
+            int thread;
+        };
+
+        // written by one thread, read by dump()
+        struct buffer {
+            std::unique_ptr<event[]> events;
+            size_t capacity;
+            std::atomic<size_t> count {0};
+            int thread;
+            buffer(size_t capacity, int thread): events(new event[capacity]), capacity(capacity), thread(thread) {}
+        };
+
+        int sample_every;
+        size_t events_per_thread;
+        uint64_t id;
+        std::vector<cvedix_pipeline_node> nodes;
+        std::vector<std::shared_ptr<buffer>> buffers;
+        std::mutex buffers_lock;
+        std::atomic<bool> enabled {true};
+        std::atomic<uint64_t> dropped {0};
+
+        static uint64_t next_id() {
+            static std::atomic<uint64_t> ids {1};
+            return ids++;
+        }
+
+        static int64_t now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        buffer* this_thread_buffer() {
+            // one-entry cache, a thread normally records for a single tracer
+            thread_local uint64_t cached_id = 0;
+            thread_local buffer* cached = nullptr;
+            if (cached_id == id) {
+                return cached;
+            }
+            std::lock_guard<std::mutex> guard(buffers_lock);
+            auto b = std::make_shared<buffer>(events_per_thread, static_cast<int>(buffers.size()));
+            buffers.push_back(b);
+            cached_id = id;
+            cached = b.get();
+            return cached;
+        }
+
+        void record(const cvedix_pipeline_node& node, stamp type, const std::shared_ptr<cvedix_objects::cvedix_meta>& meta) {
+            if (!enabled.load(std::memory_order_relaxed) || !meta || meta->meta_type != cvedix_objects::cvedix_meta_type::FRAME) {
+                return;
+            }
+            auto frame = static_cast<cvedix_objects::cvedix_frame_meta*>(meta.get());
+            if (frame->frame_index % sample_every != 0) {
+                return;
+            }
+            auto b = this_thread_buffer();
+            auto n = b->count.load(std::memory_order_relaxed);
+            if (n >= b->capacity) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            b->events[n] = {now(), node.index, type, frame->channel_index, frame->frame_index, b->thread};
+            b->count.store(n + 1, std::memory_order_release);
+        }
+
+        static void append_span(std::string& out, const std::string& name, int pid, int tid, int64_t begin, int64_t end, int frame_index, int thread) {
+            char buffer[256];
+            std::snprintf(buffer, sizeof(buffer),
+                          "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%d,\"thread\":%d}},\n",
+                          name.c_str(), pid, tid, begin / 1000.0, std::max<int64_t>(0, end - begin) / 1000.0, frame_index, thread);
+            out += buffer;
+        }
+
+        static std::string escape(const std::string& s) {
+            std::string out;
+            for (auto ch: s) {
+                if (ch == '"' || ch == '\\') {
+                    out += '\\';
+                }
+                out += ch;
+            }
+            return out;
+        }
+
+    public:
+        // sample_every: trace frames whose frame_index is a multiple of it. events_per_thread: buffer size of each
+        // recording thread (~32 bytes per event, 3 events per node per sampled frame)
+        cvedix_frame_tracer(int sample_every = 30, size_t events_per_thread = 1 << 16):
+                            sample_every(std::max(1, sample_every)),
+                            events_per_thread(events_per_thread),
+                            id(next_id()) {}
+
+        virtual void on_attached(const std::vector<cvedix_pipeline_node>& nodes) override {
+            this->nodes = nodes;
+        }
+
+        virtual void on_meta_arriving(const cvedix_pipeline_node& node, int, const std::shared_ptr<cvedix_objects::cvedix_meta>& meta) override {
+            record(node, stamp::ARRIVE, meta);
+        }
+
+        virtual void on_meta_handling(const cvedix_pipeline_node& node, int, const std::shared_ptr<cvedix_objects::cvedix_meta>& meta) override {
+            record(node, stamp::START, meta);
+        }
+
+        virtual void on_meta_handled(const cvedix_pipeline_node& node, int, const std::shared_ptr<cvedix_objects::cvedix_meta>& meta) override {
+            record(node, stamp::END, meta);
+        }
+
+        // pause / resume recording, recorded events are kept
+        void set_enabled(bool on) {
+            enabled = on;
+        }
+
+        // events not recorded because a thread buffer was full
+        uint64_t dropped_count() const {
+            return dropped;
+        }
+
+        // write recorded events as Chrome trace JSON, can be called while running (events recorded so far)
+        bool dump(const std::string& path) {
+            std::vector<event> events;
+            {
+                std::lock_guard<std::mutex> guard(buffers_lock);
+                for (auto& b: buffers) {
+                    auto n = b->count.load(std::memory_order_acquire);
+                    events.insert(events.end(), b->events.get(), b->events.get() + n);
+                }
+            }
+
+            // stamps of one frame at one node: arrive, start, end (0 if missing)
+            typedef std::tuple<int, int, int> key_t;    // channel, frame, node
+            struct stamps {
+                int64_t t[3] = {0, 0, 0};
+                int thread[3] = {0, 0, 0};
+            };
+            std::map<key_t, stamps> spans;
+            int64_t origin = 0;
+            for (auto& e: events) {
+                auto& s = spans[key_t(e.channel, e.frame_index, e.node)];
+                auto i = static_cast<int>(e.type);
+                if (s.t[i] == 0) {
+                    s.t[i] = e.ts;
+                    s.thread[i] = e.thread;
+                }
+                origin = origin == 0 ? e.ts : std::min(origin, e.ts);
+            }
+
+            std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+            std::map<int, bool> channels;
+            std::map<std::pair<int, int>, std::pair<int64_t, int64_t>> frames;    // (channel, frame) -> first, last
+            for (auto& sp: spans) {
+                auto channel = std::get<0>(sp.first);
+                auto frame_index = std::get<1>(sp.first);
+                auto tid = std::get<2>(sp.first) + 1;
+                auto& s = sp.second;
+                channels[channel] = true;
+                if (s.t[0] && s.t[1]) {
+                    append_span(out, "queue", channel, tid, s.t[0] - origin, s.t[1] - origin, frame_index, s.thread[1]);
+                }
+                if (s.t[1] && s.t[2]) {
+                    append_span(out, "handle", channel, tid, s.t[1] - origin, s.t[2] - origin, frame_index, s.thread[2]);
+                }
+                auto& f = frames[{channel, frame_index}];
+                for (auto t: s.t) {
+                    if (t) {
+                        f.first = f.first == 0 ? t : std::min(f.first, t);
+                        f.second = std::max(f.second, t);
+                    }
+                }
+            }
+            for (auto& f: frames) {
+                append_span(out, "frame", f.first.first, 0, f.second.first - origin, f.second.second - origin, f.first.second, 0);
+            }
+
+            // names of processes (channels) and tracks (nodes, in pipeline order)
+            for (auto& c: channels) {
+                char buffer[128];
+                std::snprintf(buffer, sizeof(buffer), "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"channel %d\"}},\n", c.first, c.first);
+                out += buffer;
+                std::snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"frame\"}},\n", c.first);
+                out += buffer;
+                for (auto& n: nodes) {
+                    out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + std::to_string(c.first) + ",\"tid\":" + std::to_string(n.index + 1) +
+                           ",\"args\":{\"name\":\"" + escape(n.name) + "\"}},\n";
+                    out += "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":" + std::to_string(c.first) + ",\"tid\":" + std::to_string(n.index + 1) +
+                           ",\"args\":{\"sort_index\":" + std::to_string(n.index + 1) + "}},\n";
+                }
+            }
+            if (out.size() > 2 && out[out.size() - 2] == ',') {
+                out.erase(out.size() - 2, 1);
+            }
+            out += "]}\n";
+
+            auto file = std::fopen(path.c_str(), "w");
+            if (!file) {
+                return false;
+            }
+            auto ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+            return std::fclose(file) == 0 && ok;
+        }
+    };
+}
@@ -8,6 +8,8 @@
 
 #include "cvedix/utils/analysis_board/cvedix_analysis_board.h"
 
+#include "cvedix_ext/nodes/infers/cvedix_shared_model_infer_node.h"
+
 /*
 * ## 1-N-N sample ##
 * 1 video input and then split into 2 branches for different infer tasks, then 2 total outputs(no need to sync in such situations).
@@ -17,19 +19,23 @@ int main() {
     CVEDIX_SET_LOG_LEVEL(cvedix_utils::cvedix_log_level::INFO);
     CVEDIX_LOGGER_INIT();
 
+    // same onnx files in both pipes, weights are kept in memory once via cvedix_model_registry (each node still parses them at construction)
+    cvedix_utils::cvedix_model_key yunet_model{"./cvedix_data/models/face/face_detection_yunet_2022mar.onnx"};
+    cvedix_utils::cvedix_model_key sface_model{"./cvedix_data/models/face/face_recognition_sface_2021dec.onnx"};
+
     // create nodes
     auto file_src_0 = std::make_shared<cvedix_nodes::cvedix_file_src_node>("file_src_0", 0, "./cvedix_data/test_video/face.mp4", 0.6);
     auto split = std::make_shared<cvedix_nodes::cvedix_split_node>("split", false, true);  // split by deep-copy not by channel!
 
     // branch a
-    auto yunet_face_detector_a = std::make_shared<cvedix_nodes::cvedix_yunet_face_detector_node>("yunet_face_detector_a", "./cvedix_data/models/face/face_detection_yunet_2022mar.onnx");
-    auto sface_face_encoder_a = std::make_shared<cvedix_nodes::cvedix_sface_feature_encoder_node>("sface_face_encoder_a", "./cvedix_data/models/face/face_recognition_sface_2021dec.onnx");
+    auto yunet_face_detector_a = std::make_shared<cvedix_nodes::cvedix_shared_model_infer_node<cvedix_nodes::cvedix_yunet_face_detector_node>>(yunet_model, 1, "yunet_face_detector_a", yunet_model.model_path);
+    auto sface_face_encoder_a = std::make_shared<cvedix_nodes::cvedix_shared_model_infer_node<cvedix_nodes::cvedix_sface_feature_encoder_node>>(sface_model, 1, "sface_face_encoder_a", sface_model.model_path);
     auto osd_a = std::make_shared<cvedix_nodes::cvedix_face_osd_node_v2>("osd_a");
     auto screen_des_a = std::make_shared<cvedix_nodes::cvedix_screen_des_node>("screen_des_a", 0);
 
     // branch b
-    auto yunet_face_detector_b = std::make_shared<cvedix_nodes::cvedix_yunet_face_detector_node>("yunet_face_detector_b", "./cvedix_data/models/face/face_detection_yunet_2022mar.onnx");
-    auto sface_face_encoder_b = std::make_shared<cvedix_nodes::cvedix_sface_feature_encoder_node>("sface_face_encoder_b", "./cvedix_data/models/face/face_recognition_sface_2021dec.onnx");
+    auto yunet_face_detector_b = std::make_shared<cvedix_nodes::cvedix_shared_model_infer_node<cvedix_nodes::cvedix_yunet_face_detector_node>>(yunet_model, 1, "yunet_face_detector_b", yunet_model.model_path);
+    auto sface_face_encoder_b = std::make_shared<cvedix_nodes::cvedix_shared_model_infer_node<cvedix_nodes::cvedix_sface_feature_encoder_node>>(sface_model, 1, "sface_face_encoder_b", sface_model.model_path);
     auto osd_b = std::make_shared<cvedix_nodes::cvedix_face_osd_node_v2>("osd_b");
     auto screen_des_b = std::make_shared<cvedix_nodes::cvedix_screen_des_node>("screen_des_b", 0);
 
@@ -7,6 +7,8 @@
 
 #include "cvedix/utils/analysis_board/cvedix_analysis_board.h"
 
+#include "cvedix_ext/nodes/infers/cvedix_shared_model_infer_node.h"
+
 /*
 * ## N-N sample ##
 * multi pipe exist separately and each pipe is 1-1-1 (can be any structure like 1-1-N, 1-N-N)
@@ -17,16 +19,20 @@ int main() {
     CVEDIX_SET_LOG_INCLUDE_THREAD_ID(false);
     CVEDIX_LOGGER_INIT();
 
+    // same onnx files in both pipes, weights are kept in memory once via cvedix_model_registry (each node still parses them at construction)
+    cvedix_utils::cvedix_model_key yunet_model{"./cvedix_data/models/face/face_detection_yunet_2022mar.onnx"};
+    cvedix_utils::cvedix_model_key sface_model{"./cvedix_data/models/face/face_recognition_sface_2021dec.onnx"};
+
     // create nodes
     auto file_src_0 = std::make_shared<cvedix_nodes::cvedix_file_src_node>("file_src_0", 0, "./cvedix_data/test_video/face.mp4", 0.6);
-    auto yunet_face_detector_0 = std::make_shared<cvedix_nodes::cvedix_yunet_face_detector_node>("yunet_face_detector_0", "./cvedix_data/models/face/face_detection_yunet_2022mar.onnx");
-    auto sface_face_encoder_0 = std::make_shared<cvedix_nodes::cvedix_sface_feature_encoder_node>("sface_face_encoder_0", "./cvedix_data/models/face/face_recognition_sface_2021dec.onnx");
+    auto yunet_face_detector_0 = std::make_shared<cvedix_nodes::cvedix_shared_model_infer_node<cvedix_nodes::cvedix_yunet_face_detector_node>>(yunet_model, 1, "yunet_face_detector_0", yunet_model.model_path);
+    auto sface_face_encoder_0 = std::make_shared<cvedix_nodes::cvedix_shared_model_infer_node<cvedix_nodes::cvedix_sface_feature_encoder_node>>(sface_model, 1, "sface_face_encoder_0", sface_model.model_path);
     auto osd_0 = std::make_shared<cvedix_nodes::cvedix_face_osd_node_v2>("osd_0");
     auto screen_des_0 = std::make_shared<cvedix_nodes::cvedix_screen_des_node>("screen_des_0", 0);
 
     auto file_src_1 = std::make_shared<cvedix_nodes::cvedix_file_src_node>("file_src_1", 0, "./cvedix_data/test_video/face2.mp4");
-    auto yunet_face_detector_1 = std::make_shared<cvedix_nodes::cvedix_yunet_face_detector_node>("yunet_face_detector_1", "./cvedix_data/models/face/face_detection_yunet_2022mar.onnx");
-    auto sface_face_encoder_1 = std::make_shared<cvedix_nodes::cvedix_sface_feature_encoder_node>("sface_face_encoder_1", "./cvedix_data/models/face/face_recognition_sface_2021dec.onnx");
+    auto yunet_face_detector_1 = std::make_shared<cvedix_nodes::cvedix_shared_model_infer_node<cvedix_nodes::cvedix_yunet_face_detector_node>>(yunet_model, 1, "yunet_face_detector_1", yunet_model.model_path);
+    auto sface_face_encoder_1 = std::make_shared<cvedix_nodes::cvedix_shared_model_infer_node<cvedix_nodes::cvedix_sface_feature_encoder_node>>(sface_model, 1, "sface_face_encoder_1", sface_model.model_path);
     auto osd_1 = std::make_shared<cvedix_nodes::cvedix_face_osd_node_v2>("osd_1");
     auto screen_des_1 = std::make_shared<cvedix_nodes::cvedix_screen_des_node>("screen_des_1", 0);
 
@@ -1,12 +1,15 @@
-#include "cvedix/nodes/src/cvedix_app_src_node.h"
 #include "cvedix/nodes/infers/cvedix_ppocr_text_detector_node.h"
 #include "cvedix/nodes/osd/cvedix_text_osd_node.h"
 #include "cvedix/nodes/des/cvedix_screen_des_node.h"
 #include "cvedix/utils/analysis_board/cvedix_analysis_board.h"
 
+#include "cvedix_ext/nodes/infers/cvedix_warmup_infer_node.h"
+#include "cvedix_ext/nodes/src/cvedix_app_src_node_v2.h"
+
 /*
 * ## app src sample ##
-* receive frames(cv::Mat) from host code
+* receive frames(cv::Mat) from host code, ownership of each frame is moved into the pipeline (no copy).
+* at most 4 frames are held by app_src_0, a push waits up to 500ms for room and fails after that.
 */
 
 int main() {
@@ -14,12 +17,14 @@ int main() {
     CVEDIX_LOGGER_INIT();
 
     // create nodes
-    auto app_src_0 = std::make_shared<cvedix_nodes::cvedix_app_src_node>("app_src_0", 0);
-    auto ppocr_text_detector = std::make_shared<cvedix_nodes::cvedix_ppocr_text_detector_node>("ppocr_text_detector", 
+    auto app_src_0 = std::make_shared<cvedix_nodes::cvedix_app_src_node_v2>("app_src_0", 0, 4);
+    auto load_start = std::chrono::steady_clock::now();
+    auto ppocr_text_detector = std::make_shared<cvedix_nodes::cvedix_warmup_infer_node<cvedix_nodes::cvedix_ppocr_text_detector_node>>("ppocr_text_detector", 
                                 "./cvedix_data/models/text/ppocr/ch_PP-OCRv3_det_infer",
                                 "./cvedix_data/models/text/ppocr/ch_ppocr_mobile_v2.0_cls_infer",
                                 "./cvedix_data/models/text/ppocr/ch_PP-OCRv3_rec_infer",
                                 "./cvedix_data/models/text/ppocr/ppocr_keys_v1.txt");
+    auto load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
     auto osd_0 = std::make_shared<cvedix_nodes::cvedix_text_osd_node>("osd_0", "./cvedix_data/font/NotoSansCJKsc-Medium.otf");
     auto screen_des_0 = std::make_shared<cvedix_nodes::cvedix_screen_des_node>("screen_des_0", 0);
 
@@ -28,6 +33,10 @@ int main() {
     osd_0->attach_to({ppocr_text_detector});
     screen_des_0->attach_to({osd_0});
 
+    // warm up det/cls/rec models before first frame is pushed, then report startup timings
+    auto warm_up = ppocr_text_detector->warm_up(cv::Size(1280, 720), 2);
+    std::cout << "ppocr startup: load " << load_ms << "ms, first infer " << warm_up.first_ms << "ms, steady infer " << warm_up.steady_ms << "ms" << std::endl;
+
     // start pipeline
     app_src_0->start();
 
@@ -45,9 +54,11 @@ int main() {
             auto frame = cv::imread(path + std::to_string(index) + ".jpg");
             assert(!frame.empty());
             
-            app_src_0->push_frames({frame});  // push frame to pipeline, return false means failed
-            count++;
-            std::cout << "main thread has pushed [" << count << "] frames into pipeline..." << std::endl;
+            // move frame into pipeline, return false means failed (stopped, or still full after 500ms)
+            if (app_src_0->push_frame(std::move(frame), 500)) {
+                count++;
+                std::cout << "main thread has pushed [" << count << "] frames into pipeline, free capacity " << app_src_0->free_capacity() << "..." << std::endl;
+            }
             
             index++;
             index = index % 3;
@@ -65,7 +76,7 @@ int main() {
             app_src_0->start();
         }
         else if (input == "stop") {
-            app_src_0->stop();  // app_src_0->push_frames(...) will print Warn message since it has stopped working
+            app_src_0->stop();  // app_src_0->push_frame(...) will print Warn message since it has stopped working
         }
         else {
             std::cout << "invalid command!" << std::endl;
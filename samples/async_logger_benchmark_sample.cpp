@@ -0,0 +1,147 @@
+#include "cvedix_ext/utils/logger/cvedix_async_logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+* ## async logger benchmark sample ##
+* measure caller-side latency of one log call at 6/32/128 logging threads:
+*   sync:        format + lock + write to file on the caller's thread (how a locking logger behaves)
+*   async:       cvedix_async_logger with rings sized to hold a whole run, nothing can be dropped or wait
+*   async fmt:   as async, formatting deferred to writer thread (logf, what CVEDIX_ASYNC_INFOF calls)
+*   ring drop:   default rings (256 records), ring full -> record dropped (counted)
+*   ring block:  default rings (256 records), ring full -> caller waits for the writer
+*   disabled:    DEBUG record while level is INFO, cost of the level check alone
+* latency columns are over accepted calls only, dropped calls (fast, nothing written) are counted apart, so the
+* drop path never passes for logging speed. every thread logs as fast as it can, a sustained rate no single writer
+* keeps up with at 32+ threads: compare sync with async, the ring rows show what happens once rings are too small.
+* all modes write the same lines to files in ./log_bench.
+* rings of the async rows take about records_per_thread * 210 bytes per thread (~200MB at 128 threads by default).
+*
+* usage:
+*   ./async_logger_benchmark_sample [records_per_thread]
+*/
+
+struct result {
+    size_t accepted, dropped;
+    double p50_us, p99_us, p999_us, max_us, total_ms;
+};
+
+// log_func returns false if the record was dropped
+template<typename log_func_t>
+result run(int threads, int records, log_func_t log_func) {
+    std::vector<std::vector<float>> latencies(threads);
+    std::vector<size_t> dropped(threads, 0);
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            auto& lat = latencies[t];
+            lat.reserve(records);
+            for (int i = 0; i < records; i++) {
+                auto start = std::chrono::steady_clock::now();
+                auto accepted = log_func(t, i);
+                auto us = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+                if (accepted) {
+                    lat.push_back(us);
+                }
+                else {
+                    dropped[t]++;
+                }
+            }
+        });
+    }
+    for (auto& w: workers) {
+        w.join();
+    }
+    auto total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    std::vector<float> all;
+    size_t all_dropped = 0;
+    for (int t = 0; t < threads; t++) {
+        all.insert(all.end(), latencies[t].begin(), latencies[t].end());
+        all_dropped += dropped[t];
+    }
+    if (all.empty()) {
+        return {0, all_dropped, 0, 0, 0, 0, total_ms};
+    }
+    std::sort(all.begin(), all.end());
+    auto at = [&](double q) { return static_cast<double>(all[std::min(all.size() - 1, static_cast<size_t>(q * all.size()))]); };
+    return {all.size(), all_dropped, at(0.5), at(0.99), at(0.999), all.back(), total_ms};
+}
+
+static void print(int threads, const char* mode, const result& r) {
+    std::printf("%-8d %-12s %-10zu %-10zu %-10.2f %-10.2f %-10.2f %-10.1f %-10.1f\n", threads, mode, r.accepted, r.dropped,
+                r.p50_us, r.p99_us, r.p999_us, r.max_us, r.total_ms);
+}
+
+static std::string make_message(int thread, int i) {
+    char buffer[96];
+    std::snprintf(buffer, sizeof(buffer), "thread %d record %d, some payload like a track id %d", thread, i, i * 7);
+    return buffer;
+}
+
+int main(int argc, char** argv) {
+    int records = argc > 1 ? std::atoi(argv[1]) : 5000;
+
+    // synchronous baseline writes with its own file sink under a mutex
+    auto sync_sink = std::make_shared<cvedix_utils::cvedix_file_log_sink>("./log_bench/sync");
+    std::mutex sync_lock;
+
+    auto& logger = cvedix_utils::cvedix_async_logger::get();
+    auto async_sink = std::make_shared<cvedix_utils::cvedix_file_log_sink>("./log_bench/async");
+    logger.add_sink(async_sink);
+
+    // the log calls behind CVEDIX_ASYNC_INFO / CVEDIX_ASYNC_INFOF, called directly for their accepted/dropped result
+    auto log = [&](int i) {
+        return logger.log(cvedix_utils::cvedix_async_log_level::INFO, __FILE__, __LINE__, make_message(0, i));
+    };
+    auto logf = [&](int i) {
+        return logger.logf(cvedix_utils::cvedix_async_log_level::INFO, __FILE__, __LINE__, "thread %d record %d, some payload like a track id %d", 0, i, i * 7);
+    };
+
+    std::printf("%-8s %-12s %-10s %-10s %-10s %-10s %-10s %-10s %-10s\n", "threads", "mode", "accepted", "dropped", "p50(us)", "p99(us)", "p99.9(us)", "max(us)", "total(ms)");
+    for (auto threads: {6, 32, 128}) {
+        print(threads, "sync", run(threads, records, [&](int t, int i) {
+            cvedix_utils::cvedix_log_record r;
+            r.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            r.thread_index = t;
+            r.file = __FILE__;
+            r.line = __LINE__;
+            r.message = make_message(t, i);
+            std::string text = r.message + "\n";
+            std::vector<cvedix_utils::cvedix_log_record> records;
+            records.push_back(std::move(r));
+            std::lock_guard<std::mutex> guard(sync_lock);
+            sync_sink->write(records, text);
+            sync_sink->flush();
+            return true;
+        }));
+
+        // rings hold a whole run, the writer drains them after the callers are done if it can not keep up
+        cvedix_utils::cvedix_async_logger_config sized;
+        sized.ring_capacity = records;
+        logger.start(sized);
+        print(threads, "async", run(threads, records, [&](int, int i) { return log(i); }));
+        print(threads, "async fmt", run(threads, records, [&](int, int i) { return logf(i); }));
+        print(threads, "disabled", run(threads, records, [&](int, int i) {
+            CVEDIX_ASYNC_DEBUG(make_message(0, i));     // message never built
+            return true;
+        }));
+        logger.stop();
+
+        for (auto policy: {cvedix_utils::cvedix_log_overflow_policy::DROP, cvedix_utils::cvedix_log_overflow_policy::BLOCK}) {
+            cvedix_utils::cvedix_async_logger_config config;
+            config.overflow_policy = policy;
+            logger.start(config);
+            auto r = run(threads, records, [&](int, int i) { return log(i); });
+            logger.stop();
+            print(threads, policy == cvedix_utils::cvedix_log_overflow_policy::DROP ? "ring drop" : "ring block", r);
+        }
+    }
+}
@@ -2,6 +2,7 @@
 #include "cvedix/nodes/infers/cvedix_yolo_detector_node.h"
 #include "cvedix/nodes/track/cvedix_sort_track_node.h"
 #include "cvedix/nodes/ba/cvedix_ba_crossline_node.h"
+#include "cvedix_ext/nodes/ba/cvedix_ba_multi_crossline_node.h"
 #include "cvedix/nodes/osd/cvedix_ba_crossline_osd_node.h"
 #include "cvedix/nodes/des/cvedix_screen_des_node.h"
 #include "cvedix/nodes/des/cvedix_rtmp_des_node.h"
@@ -27,6 +28,16 @@ int main() {
     cvedix_objects::cvedix_point end(700, 220);  // change to proper value
     std::map<int, cvedix_objects::cvedix_line> lines = {{0, cvedix_objects::cvedix_line(start, end)}};  // channel0 -> line
     auto ba_crossline = std::make_shared<cvedix_nodes::cvedix_ba_crossline_node>("ba_crossline", lines);
+    // more counting lines on the same channel (one per lane for example), only lines near a track are tested
+    std::map<int, std::vector<cvedix_objects::cvedix_line>> lane_lines = {
+        {0, {cvedix_objects::cvedix_line(cvedix_objects::cvedix_point(0, 300), cvedix_objects::cvedix_point(230, 290)),
+             cvedix_objects::cvedix_line(cvedix_objects::cvedix_point(230, 290), cvedix_objects::cvedix_point(470, 280)),
+             cvedix_objects::cvedix_line(cvedix_objects::cvedix_point(470, 280), cvedix_objects::cvedix_point(700, 270))}}};  // change to proper value
+    auto ba_lane_crossline = std::make_shared<cvedix_nodes::cvedix_ba_multi_crossline_node>("ba_lane_crossline", lane_lines);
+    ba_lane_crossline->set_crossline_hooker([](std::string node_name, const cvedix_nodes::cvedix_crossline_event& e) {
+        CVEDIX_INFO(cvedix_utils::string_format("[%s] channel %d, track %d crossed lane line %d (direction %d)",
+                    node_name.c_str(), e.channel_index, e.track_id, e.line_id, e.direction));
+    });
     auto osd = std::make_shared<cvedix_nodes::cvedix_ba_crossline_osd_node>("osd");
     auto screen_des_0 = std::make_shared<cvedix_nodes::cvedix_screen_des_node>("screen_des_0", 0);
     auto rtmp_des_0 = std::make_shared<cvedix_nodes::cvedix_rtmp_des_node>("rtmp_des_0", 0, "rtmp://192.168.77.60/live/9000");
@@ -35,7 +46,8 @@ int main() {
     yolo_detector->attach_to({file_src_0});
     tracker->attach_to({yolo_detector});
     ba_crossline->attach_to({tracker});
-    osd->attach_to({ba_crossline});
+    ba_lane_crossline->attach_to({ba_crossline});
+    osd->attach_to({ba_lane_crossline});
     screen_des_0->attach_to({osd});
     rtmp_des_0->attach_to({osd});
 
@@ -1,9 +1,11 @@
 #include "cvedix/nodes/src/cvedix_file_src_node.h"
 #include "cvedix/nodes/infers/cvedix_trt_vehicle_detector.h"
-#include "cvedix/nodes/track/cvedix_sort_track_node.h"
+#include "cvedix_ext/nodes/track/cvedix_fast_sort_track_node.h"
+#include "cvedix_ext/nodes/ba/cvedix_region_filter_node.h"
+#include "cvedix_ext/nodes/ba/cvedix_ba_aggregate_node.h"
 #include "cvedix/nodes/ba/cvedix_ba_jam_node.h"
 #include "cvedix/nodes/osd/cvedix_ba_jam_osd_node.h"
-#include "cvedix/nodes/record/cvedix_record_node.h"
+#include "cvedix_ext/nodes/record/cvedix_packet_record_node.h"
 #include "cvedix/nodes/mid/cvedix_split_node.h"
 #include "cvedix/nodes/des/cvedix_screen_des_node.h"
 
@@ -22,7 +24,10 @@ int main() {
     auto file_src_0 = std::make_shared<cvedix_nodes::cvedix_file_src_node>("file_src_0", 0, "./cvedix_data/test_video/jam.mp4", 0.5);
     auto file_src_1 = std::make_shared<cvedix_nodes::cvedix_file_src_node>("file_src_1", 1, "./cvedix_data/test_video/jam2.mp4");
     auto trt_vehicle_detector = std::make_shared<cvedix_nodes::cvedix_trt_vehicle_detector>("vehicle_detector", "./cvedix_data/models/trt/vehicle/vehicle_v8.5.trt");
-    auto tracker = std::make_shared<cvedix_nodes::cvedix_sort_track_node>("sort_tracker");
+    // 150+ vehicles per frame in jam scenes, use grid gated association instead of Hungarian
+    // 2 channels share one tracker, each channel is a shard updated in parallel (1 pool thread + node's thread)
+    auto tracker = std::make_shared<cvedix_nodes::cvedix_fast_sort_track_node>("sort_tracker", cvedix_nodes::cvedix_track_for::NORMAL,
+                                                                               cvedix_nodes::cvedix_fast_sort_config(), 50, 256, 1, 2);
     
     // define a region in frame for every channel (value MUST in the scope of frame'size)
     std::map<int, std::vector<cvedix_objects::cvedix_point>> regions = {
@@ -36,9 +41,29 @@ int main() {
                                             cvedix_objects::cvedix_point(968*0.6, 166*0.6), 
                                             cvedix_objects::cvedix_point(1220*0.6, 665*0.6)}} // channel1 -> region
                                             };
+    // hide targets outside regions (one mask lookup each) from the ba node's polygon test, put back right after it
+    auto region_filter = std::make_shared<cvedix_nodes::cvedix_region_filter_node>("region_filter", regions);
+    auto region_restore = region_filter->make_restore_node("region_restore");
     auto ba_jam = std::make_shared<cvedix_nodes::cvedix_ba_jam_node>("ba_jam", regions);
+    // jam counts of the jam regions added up from ba_jam's results, one compact summary per channel every 10 seconds
+    std::map<int, std::vector<std::vector<cvedix_objects::cvedix_point>>> zones;
+    for (auto& [channel_index, region]: regions) {
+        zones[channel_index] = {region};
+    }
+    auto ba_aggregate = std::make_shared<cvedix_nodes::cvedix_ba_aggregate_node>("ba_aggregate", zones, std::map<int, int>(), 10);
+    ba_aggregate->set_summary_hooker([](std::string node_name, const cvedix_nodes::cvedix_ba_summary& summary) {
+        CVEDIX_INFO(cvedix_utils::string_format("[%s] %s", node_name.c_str(), summary.to_json().c_str()));
+    });
     auto osd = std::make_shared<cvedix_nodes::cvedix_ba_jam_osd_node>("jam_osd");
-    auto recorder = std::make_shared<cvedix_nodes::cvedix_record_node>("recorder", "./record", "./record");
+    // jam clips with 5 seconds pre-roll kept as encoded H.264 packets (about bitrate x 5s per channel), remuxed to mp4 on trigger
+    // image records are written as jpeg through the same I/O thread
+    auto recorder = std::make_shared<cvedix_nodes::cvedix_packet_record_node>("recorder", "./record", "./record", 5, 2048, 25, true);
+    recorder->set_video_record_complete_hooker([](int channel, cvedix_nodes::cvedix_record_info record_info) {
+        CVEDIX_INFO(cvedix_utils::string_format("channel:[%d] video record completed, full path: %s", channel, record_info.full_record_path.c_str()));
+    });
+    recorder->set_image_record_complete_hooker([](int channel, cvedix_nodes::cvedix_record_info record_info) {
+        CVEDIX_INFO(cvedix_utils::string_format("channel:[%d] image record completed, full path: %s", channel, record_info.full_record_path.c_str()));
+    });
     auto split = std::make_shared<cvedix_nodes::cvedix_split_node>("split", true);
     auto screen_des_0 = std::make_shared<cvedix_nodes::cvedix_screen_des_node>("screen_des_0", 0);
     auto screen_des_1 = std::make_shared<cvedix_nodes::cvedix_screen_des_node>("screen_des_1", 1);
@@ -46,8 +71,11 @@ int main() {
     // construct pipeline
     trt_vehicle_detector->attach_to({file_src_0, file_src_1});
     tracker->attach_to({trt_vehicle_detector});
-    ba_jam->attach_to({tracker});
-    osd->attach_to({ba_jam});
+    region_filter->attach_to({tracker});
+    ba_jam->attach_to({region_filter});
+    region_restore->attach_to({ba_jam});
+    ba_aggregate->attach_to({region_restore});
+    osd->attach_to({ba_aggregate});
     recorder->attach_to({osd});
     split->attach_to({recorder});
     screen_des_0->attach_to({split});
@@ -1,6 +1,7 @@
 #include "cvedix/nodes/src/cvedix_file_src_node.h"
 #include "cvedix/nodes/infers/cvedix_trt_vehicle_detector.h"
-#include "cvedix/nodes/track/cvedix_sort_track_node.h"
+#include "cvedix_ext/nodes/track/cvedix_fast_sort_track_node.h"
+#include "cvedix_ext/nodes/ba/cvedix_region_filter_node.h"
 #include "cvedix/nodes/ba/cvedix_ba_stop_node.h"
 #include "cvedix/nodes/osd/cvedix_ba_stop_osd_node.h"
 #include "cvedix/nodes/mid/cvedix_split_node.h"
@@ -21,13 +22,18 @@ int main() {
     auto file_src_0 = std::make_shared<cvedix_nodes::cvedix_file_src_node>("file_src_0", 0, "./cvedix_data/test_video/vehicle_stop.mp4", 0.6);
     auto file_src_1 = std::make_shared<cvedix_nodes::cvedix_file_src_node>("file_src_1", 1, "./cvedix_data/test_video/vehicle_stop.mp4", 0.6);
     auto trt_vehicle_detector = std::make_shared<cvedix_nodes::cvedix_trt_vehicle_detector>("vehicle_detector", "./cvedix_data//models/trt/vehicle/vehicle_v8.5.trt");
-    auto tracker = std::make_shared<cvedix_nodes::cvedix_sort_track_node>("sort_tracker");
+    // 2 channels share one tracker, each channel is a shard updated in parallel (1 pool thread + node's thread)
+    auto tracker = std::make_shared<cvedix_nodes::cvedix_fast_sort_track_node>("sort_tracker", cvedix_nodes::cvedix_track_for::NORMAL,
+                                                                               cvedix_nodes::cvedix_fast_sort_config(), 50, 256, 1, 2);
     
     // define a region in frame for every channel (value MUST in the scope of frame'size)
     std::map<int, std::vector<cvedix_objects::cvedix_point>> regions = {
         {0, std::vector<cvedix_objects::cvedix_point>{cvedix_objects::cvedix_point(20, 30), cvedix_objects::cvedix_point(600, 40), cvedix_objects::cvedix_point(600, 300), cvedix_objects::cvedix_point(10, 300)}},  // channel0 -> region
         {1, std::vector<cvedix_objects::cvedix_point>{cvedix_objects::cvedix_point(20, 30), cvedix_objects::cvedix_point(1000, 40), cvedix_objects::cvedix_point(1000, 600), cvedix_objects::cvedix_point(10, 600)}}   // channel1 -> region
     };
+    // hide targets outside regions (one mask lookup each) from the ba node's polygon test, put back right after it
+    auto region_filter = std::make_shared<cvedix_nodes::cvedix_region_filter_node>("region_filter", regions);
+    auto region_restore = region_filter->make_restore_node("region_restore");
     auto ba_stop = std::make_shared<cvedix_nodes::cvedix_ba_stop_node>("ba_stop", regions);
     auto osd = std::make_shared<cvedix_nodes::cvedix_ba_stop_osd_node>("osd");
     auto split = std::make_shared<cvedix_nodes::cvedix_split_node>("split", true);
@@ -37,8 +43,10 @@ int main() {
     // construct pipeline
     trt_vehicle_detector->attach_to({file_src_0, file_src_1});
     tracker->attach_to({trt_vehicle_detector});
-    ba_stop->attach_to({tracker});
-    osd->attach_to({ba_stop});
+    region_filter->attach_to({tracker});
+    ba_stop->attach_to({region_filter});
+    region_restore->attach_to({ba_stop});
+    osd->attach_to({region_restore});
     split->attach_to({osd});
     screen_des_0->attach_to({split});
     screen_des_1->attach_to({split});
@@ -0,0 +1,86 @@
+#include "cvedix_ext/nodes/ba/crossline/cvedix_line_grid_index.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+/*
+* ## crossline benchmark sample ##
+* measure crossline evaluation cost per frame against line count and track count, grid index used by
+* cvedix_ba_multi_crossline_node vs testing every track movement against every line.
+* lines and tracks are synthetic (1920x1080), both methods must report the same number of crossings.
+*
+* usage:
+*   ./crossline_benchmark_sample [frames]
+*/
+
+struct walker {
+    float x, y, vx, vy;
+};
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::atoi(argv[1]) : 300;
+    const float frame_w = 1920, frame_h = 1080;
+
+    std::printf("%-6s %-7s %-16s %-16s %-10s\n", "lines", "tracks", "grid(ms/frame)", "brute(ms/frame)", "crossings");
+    for (auto line_count: {10, 30, 60, 120}) {
+        for (auto track_count: {100, 500}) {
+            std::mt19937 rng(line_count * 1000 + track_count);
+            std::uniform_real_distribution<float> pos_x(0, frame_w), pos_y(0, frame_h), angle(0, 6.2832f), length(100, 400), speed(-8, 8);
+
+            std::vector<cvedix_nodes::cvedix_line_segment> lines(line_count);
+            for (auto& l: lines) {
+                auto a = angle(rng), len = length(rng);
+                l.x1 = pos_x(rng);
+                l.y1 = pos_y(rng);
+                l.x2 = l.x1 + std::cos(a) * len;
+                l.y2 = l.y1 + std::sin(a) * len;
+            }
+            cvedix_nodes::cvedix_line_grid_index index(lines);
+
+            std::vector<walker> tracks(track_count);
+            for (auto& t: tracks) {
+                t = {pos_x(rng), pos_y(rng), speed(rng), speed(rng)};
+            }
+
+            std::vector<cvedix_nodes::cvedix_line_crossing> crossings;
+            double grid_ms = 0, brute_ms = 0;
+            long grid_crossings = 0, brute_crossings = 0;
+            for (int f = 0; f < frames; f++) {
+                std::vector<float> moves;   // ax, ay, bx, by per track
+                moves.reserve(track_count * 4);
+                for (auto& t: tracks) {
+                    auto ax = t.x, ay = t.y;
+                    t.x += t.vx;
+                    t.y += t.vy;
+                    if (t.x < 0 || t.x > frame_w) t.vx = -t.vx;
+                    if (t.y < 0 || t.y > frame_h) t.vy = -t.vy;
+                    moves.insert(moves.end(), {ax, ay, t.x, t.y});
+                }
+
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < track_count; i++) {
+                    crossings.clear();
+                    index.cross(moves[i * 4], moves[i * 4 + 1], moves[i * 4 + 2], moves[i * 4 + 3], crossings);
+                    grid_crossings += crossings.size();
+                }
+                grid_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                start = std::chrono::steady_clock::now();
+                for (int i = 0; i < track_count; i++) {
+                    for (auto& l: lines) {
+                        if (cvedix_nodes::cvedix_line_grid_index::crossing_direction(l, moves[i * 4], moves[i * 4 + 1], moves[i * 4 + 2], moves[i * 4 + 3])) {
+                            brute_crossings++;
+                        }
+                    }
+                }
+                brute_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            std::printf("%-6d %-7d %-16.4f %-16.4f %ld/%ld\n", line_count, track_count, grid_ms / frames, brute_ms / frames, grid_crossings, brute_crossings);
+        }
+    }
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "cvedix/utils/cvedix_utils.h"
 #include "cvedix/utils/logger/cvedix_logger.h"
+#include "cvedix_ext/utils/logger/cvedix_async_logger.h"
 
 #include <iostream>
 #include <chrono>
@@ -7,7 +8,7 @@
 
 /*
 * ## sample for cvedix_logger ##
-* show how cvedix_logger works
+* show how cvedix_logger works, logging threads write through cvedix_async_logger (per-thread rings, one writer thread)
 */
 
 int main() {
@@ -30,9 +31,21 @@ int main() {
     CVEDIX_SET_LOG_TO_KAFKA(true);  // false by default if not set
     CVEDIX_SET_LOG_KAFKA_SERVERS_AND_TOPIC("192.168.77.87:9092/cvedix_log");
     
-    // init
+    // init, sdk nodes keep logging through cvedix_logger
     CVEDIX_LOGGER_INIT();
 
+    // async backend for logging threads below, same console/file outputs as above.
+    // NOTE: the kafka settings above only apply to cvedix_logger (sdk nodes), lines of the threads below do NOT go
+    // to the kafka topic. to send them too, add a cvedix_callback_log_sink producing each batch (`text` holds all
+    // formatted lines of it) to the topic with the kafka client of your application:
+    // async_logger.add_sink(std::make_shared<cvedix_utils::cvedix_callback_log_sink>(
+    //     [&](const std::vector<cvedix_utils::cvedix_log_record>&, const std::string& text) { producer.send("cvedix_log", text); }));
+    auto& async_logger = cvedix_utils::cvedix_async_logger::get();
+    async_logger.add_sink(std::make_shared<cvedix_utils::cvedix_console_log_sink>());
+    async_logger.add_sink(std::make_shared<cvedix_utils::cvedix_file_log_sink>("./log"));
+    async_logger.set_level(cvedix_utils::cvedix_async_log_level::DEBUG);
+    async_logger.start();
+
     // 6 threads logging separately
     auto func1 = []() {
         while (true) {
@@ -41,7 +54,7 @@ int main() {
             std::stringstream ss;
             ss << std::hex << id;
             auto thread_id = ss.str(); 
-            CVEDIX_ERROR(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
+            CVEDIX_ASYNC_ERROR(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
             std::this_thread::sleep_for(std::chrono::milliseconds(2));
         }
         
@@ -54,7 +67,7 @@ int main() {
             std::stringstream ss;
             ss << std::hex << id;
             auto thread_id = ss.str(); 
-            CVEDIX_DEBUG(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
+            CVEDIX_ASYNC_DEBUG(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
             std::this_thread::sleep_for(std::chrono::milliseconds(13));
         }
         
@@ -67,7 +80,7 @@ int main() {
             std::stringstream ss;
             ss << std::hex << id;
             auto thread_id = ss.str(); 
-            CVEDIX_INFO(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
+            CVEDIX_ASYNC_INFO(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
             std::this_thread::sleep_for(std::chrono::milliseconds(4));
         }
         
@@ -80,7 +93,7 @@ int main() {
             std::stringstream ss;
             ss << std::hex << id;
             auto thread_id = ss.str(); 
-            CVEDIX_WARN(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
+            CVEDIX_ASYNC_WARN(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
         
@@ -93,7 +106,7 @@ int main() {
             std::stringstream ss;
             ss << std::hex << id;
             auto thread_id = ss.str(); 
-            CVEDIX_ERROR(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
+            CVEDIX_ASYNC_ERROR(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
         
@@ -106,7 +119,7 @@ int main() {
             std::stringstream ss;
             ss << std::hex << id;
             auto thread_id = ss.str(); 
-            CVEDIX_INFO(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
+            CVEDIX_ASYNC_INFO(cvedix_utils::string_format("thread id: %s", thread_id.c_str()));
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
         
@@ -4,6 +4,7 @@
 #include "cvedix/nodes/osd/cvedix_face_osd_node_v2.h"
 #include "cvedix/nodes/des/cvedix_screen_des_node.h"
 #include "cvedix/nodes/des/cvedix_image_des_node.h"
+#include "cvedix_ext/nodes/des/cvedix_async_image_des_node.h"
 
 #include "cvedix/utils/analysis_board/cvedix_analysis_board.h"
 
@@ -25,6 +26,15 @@ int main() {
     
     /* save to file, `%d` is placeholder for filename index */
     //auto image_des_0 = std::make_shared<cvedix_nodes::cvedix_image_des_node>("image_file_des_0", 0, "./images/%d.jpg", 3, cvedix_objects::cvedix_size(), false);
+
+    /* save to file with jpeg encoding and disk writes on a dedicated I/O thread, slow storage does not block the pipeline */
+    cvedix_utils::cvedix_async_file_writer_config io_config;
+    io_config.sync_policy = cvedix_utils::cvedix_sync_policy::BATCH;  // one flush per batch of images
+    auto io_writer = std::make_shared<cvedix_utils::cvedix_async_file_writer>(io_config);
+    auto image_file_des_0 = std::make_shared<cvedix_nodes::cvedix_async_image_des_node>("image_file_des_0", 0, "./images/%d.jpg", 3, cvedix_objects::cvedix_size(), false, 90, io_writer);
+    image_file_des_0->set_image_record_complete_hooker([](int channel, cvedix_nodes::cvedix_record_info record_info) {
+        CVEDIX_INFO(cvedix_utils::string_format("channel:[%d] image saved: %s", channel, record_info.full_record_path.c_str()));
+    });
     
     /* push via udp,  receiving command for test: `gst-launch-1.0 udpsrc port=6000 ! application/x-rtp,encoding-name=jpeg ! rtpjpegdepay ! jpegparse ! jpegdec ! queue ! videoconvert ! autovideosink` */
     auto image_des_0 = std::make_shared<cvedix_nodes::cvedix_image_des_node>("image_udp_des_0", 0, "192.168.77.248:6000", 2, cvedix_objects::cvedix_size(600, 300));
@@ -35,6 +45,7 @@ int main() {
     osd_0->attach_to({sface_face_encoder_0});
     screen_des_0->attach_to({osd_0});
     image_des_0->attach_to({osd_0});
+    image_file_des_0->attach_to({osd_0});
 
     file_src_0->start();
 
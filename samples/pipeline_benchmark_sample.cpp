@@ -0,0 +1,255 @@
+#include "cvedix/nodes/src/cvedix_app_src_node.h"
+#include "cvedix/nodes/infers/cvedix_yolo_detector_node.h"
+#include "cvedix/nodes/track/cvedix_sort_track_node.h"
+#include "cvedix/nodes/ba/cvedix_ba_crossline_node.h"
+#include "cvedix/nodes/osd/cvedix_osd_node.h"
+#include "cvedix/nodes/broker/cvedix_json_console_broker_node.h"
+#include "cvedix/nodes/des/cvedix_fake_des_node.h"
+
+#include "cvedix_ext/nodes/infers/cvedix_warmup_infer_node.h"
+#include "cvedix_ext/utils/cvedix_pipeline_hooks.h"
+#include "cvedix_ext/utils/metrics/cvedix_pipeline_metrics.h"
+
+#include <opencv2/videoio.hpp>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+/*
+* ## pipeline benchmark sample ##
+* repeatable offline throughput benchmark, no network stream or display window involved.
+* the first `pool` frames of a local video are decoded into memory up front (a small fixed pool, so the harness does
+* not grow with `frames`), then pushed round-robin through cvedix_app_src_node as fast as the pipeline takes them (at
+* most `window` frames in flight) into a configurable node chain ending in cvedix_fake_des_node:
+*   det: yolo detector, track: sort tracker, ba: crossline, osd: osd, broker: json broker (messages discarded, no I/O)
+* the detector is warmed up before timing starts. results are printed (and optionally written) as JSON:
+* throughput fps, end-to-end latency percentiles, per-node latency percentiles / frames / drops (cvedix_pipeline_metrics,
+* interpolated in histogram buckets) and RSS: baseline (harness and decoded pool only), ready (chain built, detector
+* warmed up, before start) and peak, compare peak - baseline across commits and boxes.
+*
+* usage:
+*   ./pipeline_benchmark_sample [video] [chain] [frames] [output.json]
+*   ./pipeline_benchmark_sample ./cvedix_data/test_video/vehicle_count.mp4 det,track,ba,osd,broker 1000 result.json
+*/
+
+// json broker whose messages are dropped, measures building the messages only
+class discard_broker_node: public cvedix_nodes::cvedix_json_console_broker_node {
+protected:
+    virtual void broke_msg(const std::string& msg) override {
+        bytes += msg.size();
+    }
+public:
+    std::atomic<size_t> bytes {0};
+    discard_broker_node(std::string node_name): cvedix_nodes::cvedix_json_console_broker_node(node_name) {}
+};
+
+// counts frames reaching des nodes, end-to-end latency from push to des
+class completion_listener: public cvedix_utils::cvedix_pipeline_listener {
+public:
+    std::vector<std::chrono::steady_clock::time_point> pushed;
+    std::vector<double> e2e_ms;
+    std::mutex lock;
+    std::condition_variable done_changed;
+    size_t done = 0;
+
+    virtual void on_meta_handling(const cvedix_utils::cvedix_pipeline_node& node, int, const std::shared_ptr<cvedix_objects::cvedix_meta>& meta) override {
+        if (node.kind != cvedix_utils::cvedix_pipeline_node_kind::DES || !meta || meta->meta_type != cvedix_objects::cvedix_meta_type::FRAME) {
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> guard(lock);
+        // app src keeps order and nothing in the chain drops frames, the n-th frame out is the n-th frame pushed
+        if (done < pushed.size()) {
+            e2e_ms.push_back(std::chrono::duration<double, std::milli>(now - pushed[done]).count());
+        }
+        done++;
+        done_changed.notify_all();
+    }
+};
+
+static double percentile(std::vector<double> values, double q) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(q * values.size()))];
+}
+
+// current resident set, MB
+static double current_rss_mb() {
+    long pages = 0, resident = 0;
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        std::fclose(f);
+    }
+    return resident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024 * 1024);
+}
+
+static std::string json_number(double v) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", std::isnan(v) ? 0.0 : v);
+    return buffer;
+}
+
+int main(int argc, char** argv) {
+    std::string video = argc > 1 ? argv[1] : "./cvedix_data/test_video/vehicle_count.mp4";
+    std::string chain = argc > 2 ? argv[2] : "det,track,ba,osd,broker";
+    int frames = argc > 3 ? std::atoi(argv[3]) : 500;
+    std::string output = argc > 4 ? argv[4] : "";
+    const size_t window = 8;
+    const int pool = 32;    // decoded frames kept in memory, ~200MB at 1080p
+
+    CVEDIX_SET_LOG_LEVEL(cvedix_utils::cvedix_log_level::WARN);
+    CVEDIX_LOGGER_INIT();
+
+    // decode a small pool up front so decoding speed and disk are not part of the result
+    std::vector<cv::Mat> decoded;
+    {
+        cv::VideoCapture capture(video);
+        cv::Mat frame;
+        while (static_cast<int>(decoded.size()) < std::min(frames, pool) && capture.read(frame)) {
+            decoded.push_back(frame.clone());
+        }
+    }
+    if (decoded.empty()) {
+        std::fprintf(stderr, "can not read frames from %s\n", video.c_str());
+        return 1;
+    }
+    auto baseline_rss_mb = current_rss_mb();
+
+    // build chain
+    auto app_src_0 = std::make_shared<cvedix_nodes::cvedix_app_src_node>("app_src_0", 0);
+    std::shared_ptr<cvedix_nodes::cvedix_node> last = app_src_0;
+    std::shared_ptr<cvedix_nodes::cvedix_warmup_infer_node<cvedix_nodes::cvedix_yolo_detector_node>> detector;
+    std::stringstream chain_stream(chain);
+    std::string stage;
+    while (std::getline(chain_stream, stage, ',')) {
+        std::shared_ptr<cvedix_nodes::cvedix_node> node;
+        if (stage == "det") {
+            detector = std::make_shared<cvedix_nodes::cvedix_warmup_infer_node<cvedix_nodes::cvedix_yolo_detector_node>>("yolo_detector",
+                        "./cvedix_data/models/det_cls/yolov3-tiny-2022-0721_best.weights",
+                        "./cvedix_data/models/det_cls/yolov3-tiny-2022-0721.cfg",
+                        "./cvedix_data/models/det_cls/yolov3_tiny_5classes.txt");
+            node = detector;
+        }
+        else if (stage == "track") {
+            node = std::make_shared<cvedix_nodes::cvedix_sort_track_node>("sort_tracker");
+        }
+        else if (stage == "ba") {
+            std::map<int, cvedix_objects::cvedix_line> lines = {{0, cvedix_objects::cvedix_line(cvedix_objects::cvedix_point(0, 250), cvedix_objects::cvedix_point(700, 220))}};
+            node = std::make_shared<cvedix_nodes::cvedix_ba_crossline_node>("ba_crossline", lines);
+        }
+        else if (stage == "osd") {
+            node = std::make_shared<cvedix_nodes::cvedix_osd_node>("osd");
+        }
+        else if (stage == "broker") {
+            node = std::make_shared<discard_broker_node>("json_broker");
+        }
+        else {
+            std::fprintf(stderr, "unknown stage '%s', use det,track,ba,osd,broker\n", stage.c_str());
+            return 1;
+        }
+        node->attach_to({last});
+        last = node;
+    }
+    auto fake_des_0 = std::make_shared<cvedix_nodes::cvedix_fake_des_node>("fake_des_0", 0);
+    fake_des_0->attach_to({last});
+
+    if (detector) {
+        detector->warm_up(decoded[0].size(), 3);
+    }
+
+    // instrument with a private registry so nothing else shows up in the result
+    cvedix_utils::cvedix_metrics_registry registry;
+    auto hooks = std::make_shared<cvedix_utils::cvedix_pipeline_hooks>(std::vector<std::shared_ptr<cvedix_nodes::cvedix_node>>{app_src_0});
+    auto metrics = std::make_shared<cvedix_utils::cvedix_pipeline_metrics>(registry);
+    auto completion = std::make_shared<completion_listener>();
+    completion->pushed.reserve(frames);
+    completion->e2e_ms.reserve(frames);
+    hooks->add_listener(metrics);
+    hooks->add_listener(completion);
+
+    auto ready_rss_mb = current_rss_mb();
+    app_src_0->start();
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        {
+            std::unique_lock<std::mutex> guard(completion->lock);
+            completion->done_changed.wait(guard, [&]() { return completion->pushed.size() - completion->done < window; });
+            completion->pushed.push_back(std::chrono::steady_clock::now());
+        }
+        // a copy per push, nodes may write into frames they receive
+        app_src_0->push_frames({decoded[i % decoded.size()].clone()});
+    }
+    bool complete;
+    {
+        std::unique_lock<std::mutex> guard(completion->lock);
+        complete = completion->done_changed.wait_for(guard, std::chrono::seconds(30), [&]() { return completion->done >= static_cast<size_t>(frames); });
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    app_src_0->detach_recursively();
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // result
+    std::string json = "{\n";
+    json += "  \"video\": \"" + video + "\",\n";
+    json += "  \"chain\": \"" + chain + "\",\n";
+    json += "  \"resolution\": [" + std::to_string(decoded[0].cols) + ", " + std::to_string(decoded[0].rows) + "],\n";
+    json += "  \"frames\": " + std::to_string(frames) + ",\n";
+    json += "  \"completed\": " + std::to_string(completion->done) + ",\n";
+    json += "  \"elapsed_s\": " + json_number(elapsed) + ",\n";
+    json += "  \"fps\": " + json_number(completion->done / elapsed) + ",\n";
+    json += "  \"e2e_latency_ms\": {\"p50\": " + json_number(percentile(completion->e2e_ms, 0.5)) +
+            ", \"p90\": " + json_number(percentile(completion->e2e_ms, 0.9)) +
+            ", \"p99\": " + json_number(percentile(completion->e2e_ms, 0.99)) +
+            ", \"max\": " + json_number(percentile(completion->e2e_ms, 1.0)) + "},\n";
+    json += "  \"decoded_pool\": " + std::to_string(decoded.size()) + ",\n";
+    json += "  \"rss_mb\": {\"baseline\": " + json_number(baseline_rss_mb) +
+            ", \"ready\": " + json_number(ready_rss_mb) +
+            ", \"peak\": " + json_number(usage.ru_maxrss / 1024.0) +
+            ", \"peak_over_baseline\": " + json_number(usage.ru_maxrss / 1024.0 - baseline_rss_mb) + "},\n";
+    json += "  \"nodes\": [\n";
+    auto& nodes = hooks->get_nodes();
+    for (size_t i = 0; i < nodes.size(); i++) {
+        cvedix_utils::cvedix_metric_labels labels {{"node", nodes[i].name}};
+        auto latency = registry.histogram("cvedix_node_latency_seconds", "", labels);
+        auto counts = latency->snapshot();
+        auto frames_out = registry.counter("cvedix_node_frames_out_total", "", labels)->value();
+        json += "    {\"name\": \"" + nodes[i].name + "\"" +
+                ", \"frames_in\": " + std::to_string(registry.counter("cvedix_node_frames_in_total", "", labels)->value()) +
+                ", \"frames_out\": " + std::to_string(frames_out) +
+                ", \"dropped\": " + std::to_string(registry.counter("cvedix_node_frames_dropped_total", "", labels)->value()) +
+                ", \"fps\": " + json_number(frames_out / elapsed) +
+                ", \"latency_ms\": {\"p50\": " + json_number(latency->quantile(counts, 0.5) * 1000) +
+                ", \"p90\": " + json_number(latency->quantile(counts, 0.9) * 1000) +
+                ", \"p99\": " + json_number(latency->quantile(counts, 0.99) * 1000) + "}}" +
+                (i + 1 < nodes.size() ? ",\n" : "\n");
+    }
+    json += "  ]\n}\n";
+
+    std::printf("%s", json.c_str());
+    if (!output.empty()) {
+        std::ofstream(output) << json;
+    }
+    if (!complete) {
+        std::fprintf(stderr, "only %zu of %d frames reached fake_des_0 within 30s after the last push\n", completion->done, frames);
+        return 2;
+    }
+    return 0;
+}
@@ -1,6 +1,6 @@
 #include "cvedix/nodes/src/cvedix_image_src_node.h"
 #include "cvedix/nodes/infers/cvedix_trt_vehicle_plate_detector_v2.h"
-#include "cvedix/nodes/osd/cvedix_plate_osd_node.h"
+#include "cvedix_ext/nodes/osd/cvedix_atlas_plate_osd_node.h"
 #include "cvedix/nodes/des/cvedix_screen_des_node.h"
 #include "cvedix/utils/analysis_board/cvedix_analysis_board.h"
 
@@ -16,7 +16,8 @@ int main() {
     // create nodes
     auto image_src_0 = std::make_shared<cvedix_nodes::cvedix_image_src_node>("image_src_0", 0, "./cvedix_data/test_images/plates/%d.jpg", 1);
     auto plate_detector = std::make_shared<cvedix_nodes::cvedix_trt_vehicle_plate_detector_v2>("plate_detector", "./cvedix_data/models/trt/plate/det_v8.5.trt", "./cvedix_data/models/trt/plate/rec_v8.5.trt");
-    auto osd_0 = std::make_shared<cvedix_nodes::cvedix_plate_osd_node>("osd_0", "./cvedix_data/font/NotoSansCJKsc-Medium.otf");
+    // plate osd with plate strings drawn from cached glyphs instead of freetype on every frame
+    auto osd_0 = std::make_shared<cvedix_nodes::cvedix_atlas_plate_osd_node>("osd_0", "./cvedix_data/font/NotoSansCJKsc-Medium.otf");
     auto screen_des_0 = std::make_shared<cvedix_nodes::cvedix_screen_des_node>("screen_des_0", 0);
 
     // construct pipeline 
@@ -6,13 +6,13 @@
 #include "cvedix/nodes/des/cvedix_screen_des_node.h"
 #include "cvedix/nodes/des/cvedix_rtmp_des_node.h"
 #include "cvedix/nodes/mid/cvedix_split_node.h"
-#include "cvedix/nodes/record/cvedix_record_node.h"
+#include "cvedix_ext/nodes/record/cvedix_packet_record_node.h"
 
 #include "cvedix/utils/analysis_board/cvedix_analysis_board.h"
 
 /*
 * ## record sample ##
-* show how to use cvedix_record_node to record image and video.
+* show how to use cvedix_packet_record_node to record image and video (pre-roll kept as encoded H.264 packets instead of raw frames).
 * NOTE:
 * the recording signal in this demo is triggered by users outside pipe (via calling cvedix_src_node::record_video_manually or cvedix_src_node::record_image_manually)
 * in product situations, recording signal is triggered inside pipe automatically.
@@ -31,7 +31,8 @@ int main() {
     auto sface_face_encoder = std::make_shared<cvedix_nodes::cvedix_sface_feature_encoder_node>("sface_face_encoder_0", "./cvedix_data/models/face/face_recognition_sface_2021dec.onnx");
     auto track = std::make_shared<cvedix_nodes::cvedix_sort_track_node>("track", cvedix_nodes::cvedix_track_for::FACE);
     auto osd = std::make_shared<cvedix_nodes::cvedix_face_osd_node>("osd");    
-    auto recorder = std::make_shared<cvedix_nodes::cvedix_record_node>("recorder", "./record", "./record");
+    // 5 seconds pre-roll, remuxed to mp4 and written with images on one I/O thread
+    auto recorder = std::make_shared<cvedix_nodes::cvedix_packet_record_node>("recorder", "./record", "./record", 5);
 
     auto split = std::make_shared<cvedix_nodes::cvedix_split_node>("split", true);  // split by channel index
     auto screen_des_0 = std::make_shared<cvedix_nodes::cvedix_screen_des_node>("screen_des_0", 0);
@@ -49,7 +50,7 @@ int main() {
     screen_des_1->attach_to({split});
 
     /*
-    * set hookers for cvedix_record_node when task compeleted
+    * set hookers for cvedix_packet_record_node when task compeleted
     */
     // define hooker 
     auto record_hooker = [](int channel, cvedix_nodes::cvedix_record_info record_info) {
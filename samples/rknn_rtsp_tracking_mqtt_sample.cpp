@@ -33,6 +33,7 @@
 #include <set>
 #include <opencv2/imgcodecs.hpp>
 #include "cvedix/nodes/broker/cereal_archive/cvedix_objects_cereal_archive.h"
+#include "cvedix_ext/utils/logger/cvedix_log_rate_limit.h"
 #include "cpp_base64/base64.h"
 
 #ifdef CVEDIX_WITH_MQTT
@@ -385,10 +386,11 @@ protected:
             try {
                 mqtt_publisher_(msg);
             } catch (const std::exception& e) {
-                CVEDIX_ERROR(cvedix_utils::string_format("[%s] MQTT publish failed: %s", 
+                // broker unreachable fails every publish, keep it to one line per 5s
+                CVEDIX_LOG_EVERY_MS(CVEDIX_ERROR, 5000, cvedix_utils::string_format("[%s] MQTT publish failed: %s", 
                     node_name.c_str(), e.what()));
             } catch (...) {
-                CVEDIX_ERROR(cvedix_utils::string_format("[%s] MQTT publish failed with unknown error", 
+                CVEDIX_LOG_EVERY_MS(CVEDIX_ERROR, 5000, cvedix_utils::string_format("[%s] MQTT publish failed with unknown error", 
                     node_name.c_str()));
             }
         }
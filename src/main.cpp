@@ -5,13 +5,19 @@
 #include "cvedix/nodes/osd/cvedix_ba_crossline_osd_node.h"
 #include "cvedix/nodes/des/cvedix_screen_des_node.h"
 #include "cvedix/nodes/des/cvedix_rtmp_des_node.h"
-#include "cvedix/utils/analysis_board/cvedix_analysis_board.h"
+
+#include "cvedix_ext/nodes/infers/cvedix_pipelined_infer_node.h"
+#include "cvedix_ext/nodes/infers/cvedix_warmup_infer_node.h"
+#include "cvedix_ext/utils/metrics/cvedix_metrics_server.h"
+#include "cvedix_ext/utils/metrics/cvedix_pipeline_metrics.h"
+#include "cvedix_ext/utils/trace/cvedix_frame_tracer.h"
 
 #include <iostream>
 #include <memory>
 #include <string>
 #include <map>
 #include <cstdlib>
+#include <chrono>
 
 /**
  * @file main.cpp
@@ -58,6 +64,10 @@ int main(int argc, char* argv[]) {
     std::string yolo_weights = "./cvedix_data/models/det_cls/yolov3-tiny-2022-0721_best.weights";
     std::string yolo_config = "./cvedix_data/models/det_cls/yolov3-tiny-2022-0721.cfg";
     std::string yolo_classes = "./cvedix_data/models/det_cls/yolov3_tiny_5classes.txt";
+    // Number of frames in flight inside the detector (preprocess / infer / postprocess overlap)
+    int yolo_inflight_depth = 3;
+    // Resolution of frames reaching the detector, used for the warm-up pass before the source starts
+    cv::Size yolo_warm_up_size(1280, 720);
 
     // Crossline configuration (adjust these values based on your camera view)
     // Line coordinates must be within frame dimensions
@@ -91,14 +101,18 @@ int main(int argc, char* argv[]) {
             rtsp_fps
         );
 
-        // Create YOLO detector node
+        // Create YOLO detector node (stages pipelined on separate threads, output order preserved)
         std::cout << "[2/7] Creating YOLO detector node..." << std::endl;
-        auto yolo_detector = std::make_shared<cvedix_nodes::cvedix_yolo_detector_node>(
+        auto load_start = std::chrono::steady_clock::now();
+        auto yolo_detector = std::make_shared<cvedix_nodes::cvedix_pipelined_infer_node<
+            cvedix_nodes::cvedix_warmup_infer_node<cvedix_nodes::cvedix_yolo_detector_node>>>(
+            yolo_inflight_depth,
             "yolo_detector",
             yolo_weights,
             yolo_config,
             yolo_classes
         );
+        auto load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
 
         // Create SORT tracker node
         std::cout << "[3/7] Creating SORT tracker node..." << std::endl;
@@ -144,6 +158,40 @@ int main(int argc, char* argv[]) {
 
         std::cout << "Pipeline connected successfully!" << std::endl;
 
+        // Warm up the detector with dummy frames so the first real frames do not pay backend allocations
+        std::cout << "\nWarming up YOLO detector..." << std::endl;
+        auto warm_up = yolo_detector->warm_up(yolo_warm_up_size, 3);
+        std::cout << "Startup timings: model load=" << load_ms << "ms, first infer=" << warm_up.first_ms
+                  << "ms, steady infer=" << warm_up.steady_ms << "ms" << std::endl;
+
+        // Per-node fps, queue depth, latency and drops for Prometheus (headless replacement of the analysis board)
+        // CVEDIX_METRICS_PORT overrides the port, 0 disables the endpoint.
+        // CVEDIX_TRACE_FILE records queue wait / handling spans of 1 in CVEDIX_TRACE_SAMPLE (30) frames per node
+        // and writes them as Chrome trace JSON on exit (open in https://ui.perfetto.dev)
+        int metrics_port = getenv("CVEDIX_METRICS_PORT") ? std::atoi(getenv("CVEDIX_METRICS_PORT")) : 9464;
+        std::string trace_file = getenv("CVEDIX_TRACE_FILE") ? getenv("CVEDIX_TRACE_FILE") : "";
+        std::shared_ptr<cvedix_utils::cvedix_pipeline_hooks> pipeline_hooks;
+        std::unique_ptr<cvedix_utils::cvedix_metrics_server> metrics_server;
+        std::shared_ptr<cvedix_utils::cvedix_frame_tracer> frame_tracer;
+        if (metrics_port > 0 || !trace_file.empty()) {
+            pipeline_hooks = std::make_shared<cvedix_utils::cvedix_pipeline_hooks>(std::vector<std::shared_ptr<cvedix_nodes::cvedix_node>>{rtsp_src_0});
+        }
+        if (metrics_port > 0) {
+            pipeline_hooks->add_listener(std::make_shared<cvedix_utils::cvedix_pipeline_metrics>());
+            metrics_server.reset(new cvedix_utils::cvedix_metrics_server(metrics_port));
+            if (metrics_server->start()) {
+                std::cout << "Metrics: http://127.0.0.1:" << metrics_port << "/metrics" << std::endl;
+            }
+            else {
+                std::cerr << "Metrics endpoint could not bind port " << metrics_port << std::endl;
+            }
+        }
+        if (!trace_file.empty()) {
+            int sample_every = getenv("CVEDIX_TRACE_SAMPLE") ? std::atoi(getenv("CVEDIX_TRACE_SAMPLE")) : 30;
+            frame_tracer = std::make_shared<cvedix_utils::cvedix_frame_tracer>(sample_every);
+            pipeline_hooks->add_listener(frame_tracer);
+        }
+
         // Start the pipeline
         std::cout << "\nStarting RTSP source..." << std::endl;
         rtsp_src_0->start();
@@ -151,10 +199,6 @@ int main(int argc, char* argv[]) {
         std::cout << "\nApplication is running..." << std::endl;
         std::cout << "Press Enter to stop..." << std::endl;
 
-        // For debug purpose - display analysis board
-        cvedix_utils::cvedix_analysis_board board({rtsp_src_0});
-        board.display(1, false);
-
         // Wait for user input to stop
         std::string wait;
         std::getline(std::cin, wait);
@@ -162,6 +206,19 @@ int main(int argc, char* argv[]) {
         std::cout << "\nStopping pipeline..." << std::endl;
         rtsp_src_0->detach_recursively();
 
+        if (frame_tracer) {
+            if (frame_tracer->dump(trace_file)) {
+                std::cout << "Frame trace written to " << trace_file << std::endl;
+            }
+            else {
+                std::cerr << "Could not write frame trace to " << trace_file << std::endl;
+            }
+        }
+
+        auto costs = yolo_detector->get_stage_costs();
+        std::cout << "YOLO stages (avg ms/frame over " << costs.jobs << " frames): preprocess=" << costs.preprocess_ms
+                  << ", infer=" << costs.infer_ms << ", postprocess=" << costs.postprocess_ms << std::endl;
+
         std::cout << "Application stopped successfully." << std::endl;
 
     } catch (const std::exception& e) {
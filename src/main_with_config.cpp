@@ -14,6 +14,8 @@
 #include "cvedix/nodes/des/cvedix_screen_des_node.h"
 #include "cvedix/nodes/des/cvedix_rtmp_des_node.h"
 #include "cvedix/utils/analysis_board/cvedix_analysis_board.h"
+#include "cvedix_ext/utils/metrics/cvedix_metrics_server.h"
+#include "cvedix_ext/utils/metrics/cvedix_pipeline_metrics.h"
 
 #include "config.h"
 
@@ -109,6 +111,18 @@ int main(int argc, char* argv[]) {
 
         std::cout << "Pipeline connected successfully!" << std::endl;
 
+        // Metrics endpoint for Prometheus (hookers are taken before the pipeline starts)
+        std::shared_ptr<cvedix_utils::cvedix_pipeline_hooks> pipeline_hooks;
+        std::unique_ptr<cvedix_utils::cvedix_metrics_server> metrics_server;
+        if (app_config::METRICS_PORT > 0 && !app_config::ENABLE_ANALYSIS_BOARD) {
+            pipeline_hooks = std::make_shared<cvedix_utils::cvedix_pipeline_hooks>(std::vector<std::shared_ptr<cvedix_nodes::cvedix_node>>{rtsp_src_0});
+            pipeline_hooks->add_listener(std::make_shared<cvedix_utils::cvedix_pipeline_metrics>());
+            metrics_server.reset(new cvedix_utils::cvedix_metrics_server(app_config::METRICS_PORT, app_config::METRICS_ADDRESS));
+            if (!metrics_server->start()) {
+                std::cerr << "Metrics endpoint could not bind port " << app_config::METRICS_PORT << std::endl;
+            }
+        }
+
         // Start the pipeline
         std::cout << "\nStarting RTSP source..." << std::endl;
         rtsp_src_0->start();